@@ -12,21 +12,39 @@
 
 namespace fierz {
 
+/**
+ * reduceGamma tags index templates of a word of n Dirac matrices
+ * 0, 1, ..., n. Transformed triplets hold at most six matrices,
+ * so tags of transformed indices are chosen above.
+ */
+static constexpr int maxTemplateTag = 6;
+
 //----------------------------------------------------------------------
 
 Expression Expression::fierzTransformed(size_t pos) const {
 	using namespace dirac::algebra;
 
-	Expression res;
-	res.terms.reserve(terms.size());
+	PolynomialBuilder<Expression> res;
 
-	for (const Term& term : terms) {
+	for (const auto& term : terms) {
 		if (pos + 1 >= term.factors.size()) {
-			res.terms.push_back(term);
+			res.addTerm(term);
 			continue;
 		}
 
-		int tag = maxIndexTag(term) + 1;
+		//Output bilinears carry tag 0, so the term's indices
+		//with that tag are renamed apart first
+		int freeTag = std::max(maxIndexTag(term), maxTemplateTag) + 1;
+		IndexIdMap apart;
+		for (int slot = 0; slot < 3; ++slot)
+			apart.emplace(IndexId{ IndexTag{ 0, slot } },
+						IndexId{ IndexTag{ freeTag, slot } });
+
+		Multilinear factors = renameIndices(term.factors, apart);
+		TensorPolynomial termCoeff =
+				renameIndices<Rational>(term.coeff, apart);
+
+		int tag = freeTag + 1;
 
 		for (int i = 0; i < 5; ++i) {
 			Rational multiplier = (i == 2) ?
@@ -39,9 +57,9 @@ Expression Expression::fierzTransformed(size_t pos) const {
 			Bilinear dual = taggedBilinear(i, tag, false);
 
 			GammaPolynomial<Rational> triplet =
-								kernel(term.factors[pos])
+								kernel(factors[pos])
 								* kernel(dual)
-								* kernel(term.factors[pos + 1]);
+								* kernel(factors[pos + 1]);
 
 			CanonicalExpr<Rational> reduced =
 					reduceGamma<Rational>(triplet);
@@ -52,31 +70,31 @@ Expression Expression::fierzTransformed(size_t pos) const {
 
 				TensorPolynomial coeff =
 						Complex<Rational>{ multiplier, Rational{ 0 } }
-						* term.coeff
+						* termCoeff
 						* reduced.coeffs(j);
 
 				Term mapped{ coeff };
-				mapped.factors = term.factors;
+				mapped.factors.assign(factors.begin(), factors.end());
 				mapped.factors[pos] = taggedBilinear(j, 0, true);
 				mapped.factors[pos + 1] = frag;
-				res.terms.push_back(mapped);
+				res.addTerm(mapped);
 			}
 		}
 	}
 
-	return res;
+	return res.finalize();
 }
 
 //----------------------------------------------------------------------
 
-int Expression::maxIndexTag(const Expression::Term& term) {
-	int max = -std::numeric_limits<int>::max();
+int Expression::maxIndexTag(const Expression::TermView& term) {
+	int max = IndexId::minTag;
 
 	for (const auto& coeffTerm: term.coeff.terms)
 		for (const auto& factor: coeffTerm.factors)
 			for (const TensorIndex& idx : factor.indices())
-				if (std::holds_alternative<IndexTag>(idx.id)) {
-					const IndexTag& iTag = std::get<IndexTag>(idx.id);
+				if (idx.id().isTag()) {
+					IndexTag iTag = idx.id().tag();
 					if (iTag.first > max)
 						max = iTag.first;
 				}
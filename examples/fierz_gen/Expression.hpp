@@ -27,6 +27,7 @@ struct Expression :
 	using Coeff = TensorPolynomial<Rational>;
 	using Base = Polynomial<TensorPolynomial<Rational>, Bilinear>;
 	using Term = typename Base::Term;
+	using TermView = typename Base::TermView;
 
 	Expression operator+(const Expression& other) const {
 		return dirac::algebra::sum<Expression,
@@ -50,7 +51,7 @@ struct Expression :
 
 	Expression fierzTransformed(size_t pos) const;
 
-	static int maxIndexTag(const Term& term);
+	static int maxIndexTag(const TermView& term);
 };
 
 }
@@ -40,7 +40,7 @@ std::string Printer::latexify(const Bilinear &expr,
 
 //----------------------------------------------------------------------
 
-Printer::LatexTerms Printer::latexify(const Expression::Term &term,
+Printer::LatexTerms Printer::latexify(const Expression::TermView& term,
 		const std::vector<
 				std::pair<std::string, std::string> > &spinorIndices) {
 	if (term.coeff.isZero())
@@ -68,7 +68,7 @@ std::string Printer::latexify(const Expression &expr,
 	size_t termCount = expr.terms.size();
 
 	TermGroups terms;
-	for (const Expression::Term& term : expr.terms)
+	for (const auto& term : expr.terms)
 		terms.push_back(latexify(term, spinorIndices));
 
 	return Base::latexify(terms);
@@ -76,7 +76,7 @@ std::string Printer::latexify(const Expression &expr,
 
 //----------------------------------------------------------------------
 
-std::string Printer::latexify(const std::vector<Bilinear>& expr,
+std::string Printer::latexify(std::span<const Bilinear> expr,
 		const std::vector<std::pair<std::string, std::string> >&
 		spinorIndices) {
 	size_t factorCount = expr.size();
@@ -102,7 +102,7 @@ std::string Printer::latexify(const Identity& identity) {
 	TermGroups leftParts;
 	leftParts.reserve(identity.left.terms.size());
 
-	for (const Expression::Term& term : identity.left.terms)
+	for (const auto& term : identity.left.terms)
 		leftParts.push_back(latexify(term, identity.leftSpinorIndices));
 
 	if (leftParts[0].empty()) {
@@ -115,7 +115,7 @@ std::string Printer::latexify(const Identity& identity) {
 
 	TermGroups rightParts;
 	rightParts.reserve(identity.right.terms.size());
-	for (const Expression::Term& term : identity.right.terms)
+	for (const auto& term : identity.right.terms)
 		rightParts.push_back(latexify(term,
 				identity.rightSpinorIndices));
 
@@ -12,6 +12,7 @@
 #include "ExprPrinter.hpp"
 #include "Expression.hpp"
 #include "Identity.hpp"
+#include <span>
 
 namespace fierz {
 
@@ -33,7 +34,7 @@ public:
 	/**
 	 * Convert a Fierz multilinear to LaTeX form
 	 */
-	std::string latexify(const std::vector<Bilinear>& expr,
+	std::string latexify(std::span<const Bilinear> expr,
 			const std::vector<std::pair<std::string, std::string> >&
 			spinorIndices);
 
@@ -41,7 +42,7 @@ public:
 	/**
 	 * Convert an expression term to LaTeX form
 	 */
-	LatexTerms latexify(const Expression::Term& term,
+	LatexTerms latexify(const Expression::TermView& term,
 			const std::vector<
 					std::pair<
 						std::string, std::string>>& spinorIndices);
@@ -49,7 +49,7 @@ GammaPolynomial<Rational> kernel(const Bilinear& bilinear) {
 //----------------------------------------------------------------------
 
 static std::optional<Expression::Term>
-tryMerge(const Expression::Term& t1, const Expression::Term& t2) {
+tryMerge(const Expression::TermView& t1, const Expression::TermView& t2) {
 	size_t factorCount = t1.factors.size();
 	if (t2.factors.size() != factorCount)
 		return std::optional<Expression::Term>{};
@@ -80,9 +80,6 @@ tryMerge(const Expression::Term& t1, const Expression::Term& t2) {
 	Complex<Rational> factor = one<Rational>();
 	forPermutations(dummyCount,
 			[&](const Permutation& perm) {
-				if (iMap)
-					return;
-
 				IndexIdMap maybeMap;
 				for (size_t i = 0; i < dummyCount; ++i)
 					maybeMap.emplace(contracted2[i],
@@ -92,10 +89,12 @@ tryMerge(const Expression::Term& t1, const Expression::Term& t2) {
 						renameIndices(t2.factors, maybeMap);
 				std::optional<Complex<Rational> > equiv =
 						equivalenceFactor(mapped, t1.factors);
-				if (equiv) {
-					iMap = maybeMap;
-					factor = equiv.value();
-				}
+				if (!equiv)
+					return WalkResult::Continue;
+
+				iMap = maybeMap;
+				factor = equiv.value();
+				return WalkResult::Stop;
 			});
 
 	if (!iMap)
@@ -172,11 +171,11 @@ Bilinear renameIndices(const Bilinear& b, const IndexIdMap& repl) {
 	mapped.reserve(b.indices().size());
 
 	for (const TensorIndex& idx: b.indices()) {
-		auto iter = repl.find(idx.id);
+		auto iter = repl.find(idx.id());
 		if (iter == repl.end())
 			mapped.push_back(idx);
 		else
-			mapped.emplace_back(iter->second, idx.isUpper);
+			mapped.emplace_back(iter->second, idx.isUpper());
 	}
 
 	return Bilinear::create(b.id(), mapped);
@@ -185,7 +184,7 @@ Bilinear renameIndices(const Bilinear& b, const IndexIdMap& repl) {
 //----------------------------------------------------------------------
 
 Multilinear
-renameIndices(const Multilinear& m, const IndexIdMap& repl) {
+renameIndices(std::span<const Bilinear> m, const IndexIdMap& repl) {
 	Multilinear res;
 	res.reserve(m.size());
 	for (const Bilinear& b: m)
@@ -196,78 +195,88 @@ renameIndices(const Multilinear& m, const IndexIdMap& repl) {
 
 //----------------------------------------------------------------------
 
-using IndexIdSet = std::unordered_set<IndexId>;
+/**
+ * Appends the second argument to the first one unless already present
+ */
+template<typename T>
+static void insertUnique(std::vector<T>& values, const T& value) {
+	if (std::find(values.begin(), values.end(), value) == values.end())
+		values.push_back(value);
+}
 
-std::vector<IndexId> contractedIndices(const Expression::Term& term) {
-	std::unordered_set<TensorIndex> freeIndices;
-	IndexIdSet res;
+//----------------------------------------------------------------------
+
+std::vector<IndexId> contractedIndices(const Expression::TermView& term) {
+	TensorIndices freeIndices;
+	std::vector<IndexId> res;
 
 	for (const Bilinear& b : term.factors)
 		for (const TensorIndex& idx: b.indices()) {
-			TensorIndex dual{ idx.id, !idx.isUpper };
-			if (freeIndices.find(dual) != freeIndices.end()) {
-				res.insert(idx.id);
-				freeIndices.erase(dual);
+			TensorIndex dual{ idx.id(), !idx.isUpper() };
+			auto pDual = std::find(freeIndices.begin(),
+									freeIndices.end(), dual);
+			if (pDual != freeIndices.end()) {
+				insertUnique(res, idx.id());
+				freeIndices.erase(pDual);
 			}
 
-			freeIndices.insert(idx);
+			insertUnique(freeIndices, idx);
 		}
 
 
 	if (!term.coeff.terms.empty()) {
-		std::unordered_set<TensorIndex> coeffIndices;
+		TensorIndices coeffIndices;
 
 		for (const auto& factor: term.coeff.terms[0].factors)
-			coeffIndices.insert(
-					factor.indices().begin(),
-					factor.indices().end());
+			for (const TensorIndex& idx: factor.indices())
+				insertUnique(coeffIndices, idx);
 
 		for (const TensorIndex& idx: coeffIndices) {
-			TensorIndex dual{ idx.id, !idx.isUpper };
-			if (freeIndices.find(dual) != freeIndices.end())
-				res.insert(idx.id);
+			TensorIndex dual{ idx.id(), !idx.isUpper() };
+			if (std::find(freeIndices.begin(), freeIndices.end(), dual)
+					!= freeIndices.end())
+				insertUnique(res, idx.id());
 		}
 	}
 
-	return std::vector<IndexId>{ res.begin(), res.end() };
+	return res;
 }
 
 //----------------------------------------------------------------------
 
 std::optional<Complex<Rational> >
-equivalenceFactor(const Multilinear& m1, const Multilinear &m2) {
+equivalenceFactor(std::span<const Bilinear> m1,
+		std::span<const Bilinear> m2) {
 	if (m1.size() != m2.size())
 		return std::optional<Complex<Rational> >{};
 
 	Complex<Rational> factor = dirac::algebra::one<Rational>();
 
-	Multilinear factors{ m2.begin(), m2.end() };
+	//Canonical forms of the second argument's factors and their signs
+	std::vector<std::pair<Bilinear, int> > factors;
+	factors.reserve(m2.size());
+	for (const Bilinear& b2 : m2) {
+		Bilinear canonical{ b2 };
+		int sign = canonical.canonicalize();
+		factors.emplace_back(canonical, sign);
+	}
+
 	for (const Bilinear& b1 : m1) {
+		Bilinear canonical{ b1 };
+		int sign = canonical.canonicalize();
+
 		auto pb2 = std::find_if(factors.begin(), factors.end(),
-				[&](const Bilinear& b2) -> bool {
-					if (b2 == b1)
-						return true;
-
-					if ((b2.id() == b1.id()) && (b1.id() == 2)) {
-						if ((b1.indices().size() != 2)
-								|| (b2.indices().size() != 2))
-							throw std::runtime_error{
-									"Invalid index count" };
-
-						if ((b1.indices()[0] == b2.indices()[1])
-							&& (b1.indices()[1] == b2.indices()[0])) {
-							factor *= - dirac::algebra::one<Rational>();
-							return true;
-						}
-					}
-
-					return false;
+				[&](const std::pair<Bilinear, int>& b2) -> bool {
+					return (b2.first == canonical);
 				});
 
 		if (pb2 == factors.end())
 			return std::optional<Complex<Rational> >{};
-		else
-			factors.erase(pb2);
+
+		if (sign * pb2->second < 0)
+			factor *= - dirac::algebra::one<Rational>();
+
+		factors.erase(pb2);
 	}
 
 	return factor;
@@ -9,12 +9,59 @@
 #define EXAMPLES_FIERZ_GEN_ALGORITHMS_HPP_
 
 #include "defs.hpp"
-#include <unordered_map>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <span>
 #include "Expression.hpp"
 
 namespace fierz {
 
-using IndexMap = std::unordered_map<TensorIndex, TensorIndex>;
+/**
+ * Small dictionary stored as a flat array of key-value pairs.
+ * Index maps here hold a handful of entries,
+ * so a linear scan over packed index handles beats hashing.
+ */
+template<typename Key, typename Value>
+class FlatMap {
+public:
+	using Entry = std::pair<Key, Value>;
+	using Entries = std::vector<Entry>;
+	using const_iterator = typename Entries::const_iterator;
+
+	const_iterator begin() const { return _entries.begin(); }
+	const_iterator end() const { return _entries.end(); }
+
+	bool empty() const { return _entries.empty(); }
+	size_t size() const { return _entries.size(); }
+
+	void reserve(size_t count) { _entries.reserve(count); }
+
+	/**
+	 * Finds the entry for a key or returns end()
+	 */
+	const_iterator find(const Key& key) const {
+		return std::find_if(_entries.begin(), _entries.end(),
+				[&key](const Entry& entry) {
+					return entry.first == key;
+				});
+	}
+
+	/**
+	 * Adds an entry unless the key is already present
+	 */
+	void emplace(const Key& key, const Value& value) {
+		if (find(key) == end())
+			_entries.emplace_back(key, value);
+	}
+
+private:
+	Entries _entries;
+};
+
+//----------------------------------------------------------------------
+
+using IndexMap = FlatMap<TensorIndex, TensorIndex>;
 
 /**
  * Replace multiple indices in a tensor polynomial.
@@ -29,19 +76,20 @@ mapIndices(const TensorPolynomial<Scalar>& src, const IndexMap& map) {
 		return src;
 
 	TensorPolynomial<Scalar> res;
+	res.terms.reserve(src.terms.size(), src.terms.factorCount());
 	for (const auto& srcTerm : src.terms) {
 		res.terms.emplace_back(srcTerm.coeff);
-		auto& destTerm = res.terms.back();
 
 		for (const auto& srcFac : srcTerm.factors) {
-			destTerm.factors.push_back(srcFac);
-			auto& destFac = destTerm.factors.back();
+			auto destFac{ srcFac };
 			size_t indexCount = destFac.indices().size();
 			for (size_t i = 0; i < indexCount; ++i) {
 				auto indexIt = map.find(destFac.indices()[i]);
 				if (indexIt != map.end())
 					destFac.replaceIndex(i, indexIt->second);
 			}
+
+			res.terms.appendFactor(destFac);
 		}
 	}
 
@@ -76,7 +124,7 @@ Bilinear taggedBilinear(int id, int tag, bool isUpper);
 
 //----------------------------------------------------------------------
 
-using IndexIdMap = std::unordered_map<IndexId, IndexId>;
+using IndexIdMap = FlatMap<IndexId, IndexId>;
 
 //----------------------------------------------------------------------
 
@@ -92,7 +140,8 @@ Bilinear renameIndices(const Bilinear& b, const IndexIdMap& repl);
  * Rename indices in a multilinear
  * using second argument as replacement dictionary
  */
-Multilinear renameIndices(const Multilinear& m, const IndexIdMap& repl);
+Multilinear renameIndices(std::span<const Bilinear> m,
+		const IndexIdMap& repl);
 
 //----------------------------------------------------------------------
 
@@ -105,25 +154,24 @@ TensorPolynomial<Scalar>
 renameIndices(const TensorPolynomial<Scalar>& src,
 		const IndexIdMap& repl) {
 	TensorPolynomial<Scalar> res;
-	res.terms.reserve(src.terms.size());
+	res.terms.reserve(src.terms.size(), src.terms.factorCount());
 
 	for (const auto& srcTerm: src.terms) {
 		res.terms.emplace_back(srcTerm.coeff);
-		auto& destTerm = res.terms.back();
 		for (const auto& factor: srcTerm.factors) {
 			TensorIndices mappedIndices;
 			mappedIndices.reserve(factor.indices().size());
 
 			for (const TensorIndex& idx : factor.indices()) {
-				auto pIdx = repl.find(idx.id);
+				auto pIdx = repl.find(idx.id());
 				if (pIdx == repl.end())
 					mappedIndices.push_back(idx);
 				else
 					mappedIndices.emplace_back(
-							pIdx->second, idx.isUpper);
+							pIdx->second, idx.isUpper());
 			}
 
-			destTerm.factors.push_back(
+			res.terms.appendFactor(
 					dirac::algebra::LI::Tensor::create(
 								factor.id(), mappedIndices));
 		}
@@ -137,7 +185,7 @@ renameIndices(const TensorPolynomial<Scalar>& src,
 /**
  * Get all contracted indices in a term
  */
-std::vector<IndexId> contractedIndices(const Expression::Term& term);
+std::vector<IndexId> contractedIndices(const Expression::TermView& term);
 
 //----------------------------------------------------------------------
 
@@ -147,7 +195,8 @@ std::vector<IndexId> contractedIndices(const Expression::Term& term);
  * otherwise returns an empty optional
  */
 std::optional<Complex<Rational>>
-equivalenceFactor(const Multilinear& m1, const Multilinear& m2);
+equivalenceFactor(std::span<const Bilinear> m1,
+		std::span<const Bilinear> m2);
 
 }
 
@@ -35,6 +35,8 @@ template<typename C, typename F>
 using Polynomial = dirac::algebra::Polynomial<C, F>;
 
 struct BilinearBasis {
+	static constexpr size_t indexCapacity = 2;
+
 	static bool allows(int id) {
 		return (id >= 0) && (id < 5);
 	}
@@ -50,6 +52,11 @@ struct BilinearBasis {
 			return 0;
 		}
 	}
+
+	static dirac::algebra::IndexSymmetry symmetry(int id) {
+		return (id == 2) ? dirac::algebra::IndexSymmetry::Antisymmetric
+						 : dirac::algebra::IndexSymmetry::None;
+	}
 };
 
 /**
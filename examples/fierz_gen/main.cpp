@@ -53,9 +53,9 @@ int main(int argc, char** argv) {
 			Identity identity;
 			Expression lhs;
 			lhs.terms.push_back(Expression::Term{ one<Rational>() });
-			lhs.terms[0].factors.push_back(
+			lhs.terms.appendFactor(
 					taggedBilinear(i, -1, false));
-			lhs.terms[0].factors.push_back(
+			lhs.terms.appendFactor(
 					taggedBilinear(i, -1, true));
 
 			identity.left = lhs;
@@ -73,9 +73,9 @@ int main(int argc, char** argv) {
 	for (int i = 0; i < 5; ++i)
 	    appendExpr(hexaBasis, [&](Expression& expr) {
 	        expr.terms.emplace_back(one<Rational>());
-	        expr.terms[0].factors.push_back(taggedBilinear(0, -1, false));
-	        expr.terms[0].factors.push_back(taggedBilinear(i, -1, false));
-	        expr.terms[0].factors.push_back(taggedBilinear(i, -1, true));
+	        expr.terms.appendFactor(taggedBilinear(0, -1, false));
+	        expr.terms.appendFactor(taggedBilinear(i, -1, false));
+	        expr.terms.appendFactor(taggedBilinear(i, -1, true));
 	    });
 
 	std::vector<TensorIndex> lower{
@@ -94,93 +94,93 @@ int main(int argc, char** argv) {
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(4, {}));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(1, { lower[0] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(3, { upper[0] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(1, { lower[0] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(4, {}));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                             Bilinear::create(3, { upper[0] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(1, { lower[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(1, { lower[2] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[1], upper[2] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(3, { lower[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(3, { lower[2] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[1], upper[2] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(LI::TensorPolynomial<Rational>{
                 LI::Tensor::create(LI::Basis::epsilon, lower)});
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(1, { upper[0] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(3, { upper[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[2], upper[3] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(LI::TensorPolynomial<Rational>{
                 LI::Tensor::create(LI::Basis::epsilon, lower)});
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(3, { upper[0] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(1, { upper[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[2], upper[3] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(LI::TensorPolynomial<Rational>{
                 LI::Tensor::create(LI::Basis::epsilon, lower)});
-        expr.terms[0].factors.push_back(Bilinear::create(4, {}));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(Bilinear::create(4, {}));
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[0], upper[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { upper[2], upper[3] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[0], upper[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[1], upper[2] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[2], upper[0] }));
     });
 
     appendExpr(hexaBasis, [&](Expression& expr) {
         expr.terms.emplace_back(one<Rational>());
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[1], upper[2] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[0], upper[1] }));
-        expr.terms[0].factors.push_back(
+        expr.terms.appendFactor(
                 Bilinear::create(2, { lower[2], upper[0] }));
     });
 
@@ -236,11 +236,11 @@ int main(int argc, char** argv) {
 		tests.emplace_back();
 		tests[0].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[0].left.terms.back().factors.push_back(
+		tests[0].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
 		tests[0].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[0].left.terms.back().factors.push_back(
+		tests[0].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
 		tests[0].leftSpinorIndices = rightIndices;
 		tests[0].rightSpinorIndices = rightIndices;
@@ -248,11 +248,11 @@ int main(int argc, char** argv) {
 		tests.emplace_back();
 		tests[1].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[1].left.terms.back().factors.push_back(
+		tests[1].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
 		tests[1].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[1].left.terms.back().factors.push_back(
+		tests[1].left.terms.appendFactor(
 				Bilinear::create(2, {lower[2], lower[1]}));
 		tests[1].leftSpinorIndices = rightIndices;
 		tests[1].rightSpinorIndices = rightIndices;
@@ -260,16 +260,16 @@ int main(int argc, char** argv) {
 		tests.emplace_back();
 		tests[2].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[2].left.terms.back().factors.push_back(
+		tests[2].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
-		tests[2].left.terms.back().factors.push_back(
+		tests[2].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
 
 		tests[2].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[2].left.terms.back().factors.push_back(
+		tests[2].left.terms.appendFactor(
 				Bilinear::create(2, {lower[0], lower[2]}));
-		tests[2].left.terms.back().factors.push_back(
+		tests[2].left.terms.appendFactor(
 				Bilinear::create(1, {upper[0]}));
 		tests[2].leftSpinorIndices = rightIndices;
 		tests[2].rightSpinorIndices = rightIndices;
@@ -277,16 +277,16 @@ int main(int argc, char** argv) {
 		tests.emplace_back();
 		tests[3].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[3].left.terms.back().factors.push_back(
+		tests[3].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
-		tests[3].left.terms.back().factors.push_back(
+		tests[3].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
 
 		tests[3].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[3].left.terms.back().factors.push_back(
+		tests[3].left.terms.appendFactor(
 				Bilinear::create(2, {lower[2], lower[0]}));
-		tests[3].left.terms.back().factors.push_back(
+		tests[3].left.terms.appendFactor(
 				Bilinear::create(1, {upper[0]}));
 		tests[3].leftSpinorIndices = rightIndices;
 		tests[3].rightSpinorIndices = rightIndices;
@@ -294,16 +294,16 @@ int main(int argc, char** argv) {
 		tests.emplace_back();
 		tests[4].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[4].left.terms.back().factors.push_back(
+		tests[4].left.terms.appendFactor(
 				Bilinear::create(2, {lower[1], lower[2]}));
-		tests[4].left.terms.back().factors.push_back(
+		tests[4].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
 
 		tests[4].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[4].left.terms.back().factors.push_back(
+		tests[4].left.terms.appendFactor(
 				Bilinear::create(1, {upper[0]}));
-		tests[4].left.terms.back().factors.push_back(
+		tests[4].left.terms.appendFactor(
 				Bilinear::create(2, {lower[2], lower[0]}));
 		tests[4].leftSpinorIndices = rightIndices;
 		tests[4].rightSpinorIndices = rightIndices;
@@ -312,17 +312,17 @@ int main(int argc, char** argv) {
 		tests[5].left.terms.emplace_back(
 				LI::Tensor::create(LI::Basis::eta,
 								{ lower[0], lower[1] }));
-		tests[5].left.terms.back().factors.push_back(
+		tests[5].left.terms.appendFactor(
 				Bilinear::create(1, {upper[0]}));
-		tests[5].left.terms.back().factors.push_back(
+		tests[5].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
 
 		tests[5].left.terms.emplace_back(
 				LI::Tensor::create(LI::Basis::eta,
 								{ lower[1], lower[2] }));
-		tests[5].left.terms.back().factors.push_back(
+		tests[5].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
-		tests[5].left.terms.back().factors.push_back(
+		tests[5].left.terms.appendFactor(
 				Bilinear::create(1, {upper[2]}));
 		tests[5].leftSpinorIndices = rightIndices;
 		tests[5].rightSpinorIndices = rightIndices;
@@ -331,17 +331,17 @@ int main(int argc, char** argv) {
 		tests[6].left.terms.emplace_back(
 				LI::Tensor::create(LI::Basis::eta,
 								{ lower[0], lower[1] }));
-		tests[6].left.terms.back().factors.push_back(
+		tests[6].left.terms.appendFactor(
 				Bilinear::create(1, {upper[0]}));
-		tests[6].left.terms.back().factors.push_back(
+		tests[6].left.terms.appendFactor(
 				Bilinear::create(1, {upper[1]}));
 
 		tests[6].left.terms.emplace_back(
 				LI::Tensor::create(LI::Basis::eta,
 								{ lower[1], lower[2] }));
-		tests[6].left.terms.back().factors.push_back(
+		tests[6].left.terms.appendFactor(
 				Bilinear::create(3, {upper[1]}));
-		tests[6].left.terms.back().factors.push_back(
+		tests[6].left.terms.appendFactor(
 				Bilinear::create(3, {upper[2]}));
 		tests[6].leftSpinorIndices = rightIndices;
 		tests[6].rightSpinorIndices = rightIndices;
@@ -350,20 +350,20 @@ int main(int argc, char** argv) {
 
 		tests[7].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(0, {}));
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(4, {}));
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(4, {}));
 
 		tests[7].left.terms.emplace_back(
 				LI::TensorPolynomial<Rational>{ one<Rational>() });
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(4, {}));
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(4, {}));
-		tests[7].left.terms.back().factors.push_back(
+		tests[7].left.terms.appendFactor(
 				Bilinear::create(4, {}));
 
 		tests[7].leftSpinorIndices = rightIndices;
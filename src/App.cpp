@@ -16,6 +16,7 @@ static const std::string modeOption{ "-m" };
 static const std::string lineTermsOption{ "-l" };
 static const std::string dummyNameOption{ "-d" };
 static const std::string applySymmetryOption{ "-s" };
+static const std::string threadsOption{ "-t" };
 
 //----------------------------------------------------------------------
 
@@ -26,7 +27,8 @@ App::App(int argc, char **argv) {
 		Mode,
 		LineTerms,
 		DummyName,
-		ApplySymmetry
+		ApplySymmetry,
+		Threads
 	};
 
 	Option expectedOption = None;
@@ -60,6 +62,11 @@ App::App(int argc, char **argv) {
 			continue;
 		}
 
+		if (threadsOption == arg) {
+			expectedOption = Threads;
+			continue;
+		}
+
 		//Process option value
 
 		switch(expectedOption) {
@@ -87,6 +94,12 @@ App::App(int argc, char **argv) {
 				_applySymmetry = maybeValue.value();
 			break;
 		}
+		case Threads: {
+			std::optional<size_t> maybeCount = getThreadCount(arg);
+			if (maybeCount.has_value())
+				algebra::setThreadCount(maybeCount.value());
+			break;
+		}
 		default:
 			break;
 		};
@@ -139,6 +152,19 @@ void App::setVar(const std::string& name, const std::string& value) {
 		return;
 	}
 
+	if (name == "threads") {
+		std::optional<size_t> maybeCount = getThreadCount(value);
+		if (maybeCount.has_value())
+			algebra::setThreadCount(maybeCount.value());
+		else
+			std::cout
+				<< "Invalid thread count."
+					" Must be an integer constant or \"auto\""
+				<< std::endl;
+
+		return;
+	}
+
 	std::cout << "Unknown variable name " << name << std::endl;
 }
 
@@ -193,6 +219,24 @@ std::optional<size_t> App::getLineTerms(const std::string &str) {
 
 //----------------------------------------------------------------------
 
+std::optional<size_t> App::getThreadCount(const std::string &str) {
+	if (str == "auto")
+		return 0;
+
+	try {
+		size_t num_chars = std::numeric_limits<size_t>::max();
+		long long count = std::stoll(str, &num_chars);
+		if ((num_chars < str.size()) || (count < 0))
+			return std::optional<size_t>{};
+
+		return static_cast<size_t>(count);
+	} catch(...) {
+		return std::optional<size_t>{};
+	}
+}
+
+//----------------------------------------------------------------------
+
 std::optional<bool> App::getBoolean(const std::string &str) {
 	if (str == "true")
 		return true;
@@ -13,6 +13,8 @@
 #include <limits>
 
 #include "algebra/Gamma.hpp"
+#include "algebra/Arena.hpp"
+#include "algebra/Parallel.hpp"
 #include "ExprPrinter.hpp"
 #include "utils.hpp"
 #include "Compiler.hpp"
@@ -54,6 +56,10 @@ public:
 	 * 						in the coefficient at \sigma^{\mu\nu}
 	 * 						will be merged using antisymmetry of \sigma,
 	 * 						default is true.
+	 * 	- threads: number of worker threads used to canonicalize
+	 * 				large polynomials, "auto" or 0 meaning the number
+	 * 				of hardware threads, which is the default,
+	 * 				1 disables parallel canonicalization.
 	 */
 	void setVar(const std::string& name, const std::string& value);
 
@@ -84,6 +90,13 @@ public:
 	 */
 	static std::optional<bool> getBoolean(const std::string& str);
 
+	/**
+	 * Parse thread count string.
+	 * Allowed values are "auto" or non-negative integer constants.
+	 * "auto" is converted to 0, meaning the number of hardware threads.
+	 */
+	static std::optional<size_t> getThreadCount(const std::string& str);
+
 	/**
 	 * Process an expression and print the result to output.
 	 * Template argument selects numeric type
@@ -153,6 +166,9 @@ int App::compute(const std::string& input,
 		std::ostream& output) const noexcept {
 	using namespace symbolic;
 	try {
+		//Everything allocated below is released at once on exit
+		algebra::EvaluationArena arena;
+
 		CanonicalExpr<Number> expr = compute<Number>(input);
 		ExprPrinter<Number> printer{ _dummyName, _lineTerms };
 		output << printer.latexify(expr) << std::endl;
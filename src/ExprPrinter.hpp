@@ -13,6 +13,7 @@
 #include <string>
 #include <unordered_map>
 #include <sstream>
+#include <cstdint>
 
 #include "algebra/Gamma.hpp"
 #include "algebra/Rational.hpp"
@@ -56,13 +57,13 @@ public:
 	 * (that is, anything with indices).
 	 */
 	std::string latexify(const std::string& tensorHead,
-							const TensorIndices& indices);
+							const algebra::LI::Tensor::Indices& indices);
 
 	/**
 	 * LaTeX representation of a Lorentz-invariant (pseudo)-tensor
 	 */
 	std::string latexify(const algebra::LI::Tensor& t) {
-		return latexify(t.id(), t.indices());
+		return latexify(t.id().str(), t.indices());
 	}
 
 	/**
@@ -153,7 +154,7 @@ public:
 private:
 	std::string _dummyIndexName;
 	size_t _lineSize;
-	std::unordered_map<algebra::IndexTag, std::string> _indexTagMap;
+	std::unordered_map<std::uint32_t, std::string> _indexTagMap;
 };
 
 extern const std::string leftBrace;
@@ -170,7 +171,7 @@ extern const std::string rightBracket;
 template<typename Scalar>
 std::string
 ExprPrinter<Scalar>::latexify(const std::string& head,
-								const TensorIndices& indices) {
+								const algebra::LI::Tensor::Indices& indices) {
 	using namespace algebra;
 	//first: upper or lower flag; second: body
 	using Fragment = std::pair<bool, std::string>;
@@ -182,11 +183,11 @@ ExprPrinter<Scalar>::latexify(const std::string& head,
 	*/
 	for (const TensorIndex& idx : indices) {
 		if (frags.empty()
-				|| (frags.back().first && !idx.isUpper)
-				|| (!frags.back().first && idx.isUpper))
-			frags.emplace_back(idx.isUpper, "");
+				|| (frags.back().first && !idx.isUpper())
+				|| (!frags.back().first && idx.isUpper()))
+			frags.emplace_back(idx.isUpper(), "");
 
-		frags.back().second += mapIndexId(idx.id);
+		frags.back().second += mapIndexId(idx.id());
 	}
 
 	std::string value = head;
@@ -276,8 +277,7 @@ ExprPrinter<Scalar>::latexify(
 	LatexTerms latex;
 	latex.reserve(poly.terms.size());
 
-	for (const typename LI::TensorPolynomial<Scalar>::Term&
-											term : poly.terms) {
+	for (const auto& term : poly.terms) {
 		if (term.coeff == zero<Scalar>())
 			continue;
 
@@ -313,17 +313,16 @@ std::string ExprPrinter<Scalar>::mapIndexId(
 									const algebra::IndexId& aId) {
 	using namespace algebra;
 
-	if (std::holds_alternative<std::string>(aId))
-		return std::get<std::string>(aId);
+	if (aId.isLabel())
+		return aId.label();
 
-	const IndexTag& tag = std::get<IndexTag>(aId);
-	auto iTag = _indexTagMap.find(tag);
+	auto iTag = _indexTagMap.find(aId.raw());
 	if (iTag != _indexTagMap.end())
 		return iTag->second;
 
 	std::string tagStr = _dummyIndexName
 			+ "_{" + std::to_string(_indexTagMap.size() + 1) + "}";
-	_indexTagMap[tag] = tagStr;
+	_indexTagMap[aId.raw()] = tagStr;
 	return tagStr;
 }
 
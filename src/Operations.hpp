@@ -12,8 +12,13 @@
 
 #include "Token.hpp"
 #include <list>
+#include <memory_resource>
 #include <string>
 #include <functional>
+#include <optional>
+#include <vector>
+#include <span>
+#include <algorithm>
 #include "algebra/Gamma.hpp"
 
 namespace dirac {
@@ -38,8 +43,12 @@ using Operand = std::variant<Literal,
 		Tensor,
 		GammaPolynomial<Scalar> >;
 
+/**
+ * Operand list. Nodes come from the default polymorphic
+ * memory resource, see algebra::EvaluationArena.
+ */
 template<typename Scalar>
-using OpList = std::list<Operand<Scalar> >;
+using OpList = std::pmr::list<Operand<Scalar> >;
 
 //----------------------------------------------------------------------
 
@@ -430,12 +439,32 @@ OpList<Scalar> toProduct(const OpList<Scalar>& ops) {
 	if (ops.empty())
 		return ops;
 
-	Operand<Scalar> value = algebra::one<Scalar>();
-	for (auto it = ops.begin(); it != ops.end(); ++it)
-		value = prod<Scalar>(value, *it);
+	/*
+	 Numeric factors commute with everything and are collected apart,
+	 polynomial factors are multiplied without intermediate
+	 canonicalization.
+	 */
+	Complex<Scalar> factor = algebra::one<Scalar>();
+	std::optional<algebra::PolynomialBuilder<GammaPolynomial<Scalar>>>
+	poly;
+	for (const Operand<Scalar>& op : ops) {
+		Operand<Scalar> value = std::holds_alternative<Literal>(op) ?
+					resolve<Scalar>(std::get<Literal>(op)) : op;
+
+		if (std::holds_alternative<Complex<Scalar>>(value))
+			factor = factor * std::get<Complex<Scalar>>(value);
+		else if (poly)
+			*poly *= getPoly<Scalar>(value);
+		else
+			poly.emplace(getPoly<Scalar>(value));
+	}
 
 	OpList<Scalar> res;
-	res.push_back(value);
+	if (poly)
+		res.push_back(factor * poly->finalize());
+	else
+		res.push_back(factor);
+
 	return res;
 }
 
@@ -465,10 +494,35 @@ CanonicalExpr<Scalar> eval(const Operand<Scalar>& value) {
 
 //----------------------------------------------------------------------
 
+/**
+ * Number of terms the operand contributes to an expanded product.
+ * Literals, numbers and tensors are single terms;
+ * zero polynomials are counted as single terms as well.
+ */
+template<typename Scalar>
+size_t termCount(const Operand<Scalar>& op) {
+	if (!std::holds_alternative<GammaPolynomial<Scalar>>(op))
+		return 1;
+
+	return std::max<size_t>(
+			std::get<GammaPolynomial<Scalar>>(op).terms.size(), 1);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Smallest number of terms of an expanded product
+ * for which the product is reduced without expansion
+ */
+constexpr size_t factorizationThreshold = 64;
+
+//----------------------------------------------------------------------
+
 /**
  * If the list contains a single value,
  * tries evaluating the value's canonical form;
- * throws an exception otherwise.
+ * otherwise evaluates the product of the list elements.
+ * Throws an exception if that fails.
  */
 template<typename Scalar>
 CanonicalExpr<Scalar> eval(const OpList<Scalar>& ops) {
@@ -478,7 +532,46 @@ CanonicalExpr<Scalar> eval(const OpList<Scalar>& ops) {
 	if (ops.size() == 1)
 		return eval<Scalar>(ops.front());
 
-	return eval<Scalar>(toProduct<Scalar>(ops));
+	//Products expanding to few terms are expanded
+	size_t expandedSize = 1;
+	for (auto iOp = ops.begin();
+			(iOp != ops.end()) && (expandedSize < factorizationThreshold);
+			++iOp)
+		expandedSize *= termCount<Scalar>(*iOp);
+
+	if (expandedSize < factorizationThreshold)
+		return eval<Scalar>(toProduct<Scalar>(ops));
+
+	/*
+	 Sums are reduced factor by factor, see algebra::reduceProduct.
+	 Numeric factors are collected apart,
+	 runs of single-term factors are multiplied out.
+	 */
+	Complex<Scalar> number = algebra::one<Scalar>();
+	std::vector<GammaPolynomial<Scalar>> factors;
+	bool lastIsTerm = false;
+	for (const Operand<Scalar>& op : ops) {
+		Operand<Scalar> value = std::holds_alternative<Literal>(op) ?
+					resolve<Scalar>(std::get<Literal>(op)) : op;
+
+		if (std::holds_alternative<Complex<Scalar>>(value)) {
+			number = number * std::get<Complex<Scalar>>(value);
+			continue;
+		}
+
+		GammaPolynomial<Scalar> poly = getPoly<Scalar>(value);
+		bool isTerm = (poly.terms.size() <= 1);
+		if (isTerm && lastIsTerm)
+			factors.back() = factors.back() * poly;
+		else
+			factors.push_back(std::move(poly));
+
+		lastIsTerm = isTerm;
+	}
+
+	factors.back() = number * factors.back();
+	return algebra::reduceProduct<Scalar>(
+			std::span<const GammaPolynomial<Scalar>>{ factors });
 }
 
 //----------------------------------------------------------------------
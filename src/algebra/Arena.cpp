@@ -0,0 +1,70 @@
+/*
+ * Arena.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#include "Arena.hpp"
+
+namespace dirac {
+
+namespace algebra {
+
+EvaluationArena::EvaluationArena()
+	: _upstream{ std::pmr::get_default_resource() } {
+	std::pmr::set_default_resource(this);
+}
+
+//----------------------------------------------------------------------
+
+EvaluationArena::~EvaluationArena() {
+	std::pmr::set_default_resource(_upstream);
+	for (std::byte* chunk : _chunks)
+		_upstream->deallocate(chunk, chunkSize, granularity);
+}
+
+//----------------------------------------------------------------------
+
+void* EvaluationArena::do_allocate(std::size_t bytes,
+		std::size_t alignment) {
+	if ((bytes > maxPooledSize) || (alignment > granularity))
+		return _upstream->allocate(bytes, alignment);
+
+	std::size_t cls = sizeClass(bytes);
+	if (FreeBlock* block = _freeLists[cls]) {
+		_freeLists[cls] = block->next;
+		return block;
+	}
+
+	std::size_t blockSize = (cls + 1) * granularity;
+	if (static_cast<std::size_t>(_end - _cursor) < blockSize) {
+		_cursor = static_cast<std::byte*>(
+						_upstream->allocate(chunkSize, granularity));
+		_end = _cursor + chunkSize;
+		_chunks.push_back(_cursor);
+	}
+
+	void* res = _cursor;
+	_cursor += blockSize;
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+void EvaluationArena::do_deallocate(void* p, std::size_t bytes,
+		std::size_t alignment) {
+	if ((bytes > maxPooledSize) || (alignment > granularity)) {
+		_upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+
+	std::size_t cls = sizeClass(bytes);
+	FreeBlock* block = static_cast<FreeBlock*>(p);
+	block->next = _freeLists[cls];
+	_freeLists[cls] = block;
+}
+
+} /* namespace algebra */
+
+} /* namespace dirac */
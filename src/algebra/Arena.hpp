@@ -0,0 +1,112 @@
+/*
+ * Arena.hpp
+ *
+ * Scoped memory arena for polynomial storage
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#ifndef SRC_ALGEBRA_ARENA_HPP_
+#define SRC_ALGEBRA_ARENA_HPP_
+
+#include <memory_resource>
+#include <array>
+#include <vector>
+#include <cstddef>
+
+namespace dirac {
+
+namespace algebra {
+
+/**
+ * Memory arena scoped to a single evaluation.
+ * While an instance is alive, it is installed as the default
+ * polymorphic memory resource, so term storage and operand lists
+ * allocated during evaluation come from it.
+ *
+ * Small blocks are carved from large chunks and recycled
+ * through per-size free lists; large blocks are passed
+ * to the previous default resource. All chunks are released
+ * in one shot when the arena is destroyed.
+ *
+ * Objects allocated from the arena must not outlive it.
+ * The arena is not thread-safe; parallelFor replaces the default
+ * resource with a thread-safe one while worker threads run.
+ */
+class EvaluationArena : public std::pmr::memory_resource {
+public:
+	EvaluationArena();
+
+	EvaluationArena(const EvaluationArena& other) = delete;
+	EvaluationArena(EvaluationArena&& other) = delete;
+	EvaluationArena& operator=(const EvaluationArena& other) = delete;
+
+	~EvaluationArena() override;
+
+protected:
+	void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+	void do_deallocate(void* p, std::size_t bytes,
+			std::size_t alignment) override;
+
+	bool do_is_equal(
+			const std::pmr::memory_resource& other) const noexcept override {
+		return (this == &other);
+	}
+
+private:
+	/**
+	 * Small block size granularity and alignment
+	 */
+	static constexpr std::size_t granularity = 16;
+
+	/**
+	 * Largest pooled block size
+	 */
+	static constexpr std::size_t maxPooledSize = 1024;
+
+	static constexpr std::size_t chunkSize = 1 << 16;
+
+	static constexpr std::size_t sizeClass(std::size_t bytes) {
+		return (bytes == 0) ? 0 : ((bytes - 1) / granularity);
+	}
+
+	struct FreeBlock {
+		FreeBlock* next;
+	};
+
+	std::pmr::memory_resource* _upstream;
+	std::array<FreeBlock*, maxPooledSize / granularity> _freeLists{};
+	std::vector<std::byte*> _chunks;
+	std::byte* _cursor = nullptr;
+	std::byte* _end = nullptr;
+};
+
+/**
+ * Installs a default polymorphic memory resource for its lifetime.
+ * Use it to allocate objects which outlive the current
+ * EvaluationArena or are shared between threads.
+ */
+class DefaultResourceScope {
+public:
+	explicit DefaultResourceScope(std::pmr::memory_resource* resource)
+		: _previous{ std::pmr::set_default_resource(resource) } {}
+
+	DefaultResourceScope(const DefaultResourceScope& other) = delete;
+	DefaultResourceScope&
+	operator=(const DefaultResourceScope& other) = delete;
+
+	~DefaultResourceScope() {
+		std::pmr::set_default_resource(_previous);
+	}
+
+private:
+	std::pmr::memory_resource* _previous;
+};
+
+}
+
+}
+
+#endif /* SRC_ALGEBRA_ARENA_HPP_ */
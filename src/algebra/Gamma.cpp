@@ -1,7 +1,7 @@
 /*
  * Gamma.cpp
  *
- *	Gamma ring constants
+ *	Gamma ring constants and gamma word shapes
  *
  *  Created on: Dec 21, 2022
  *      Author: skutnii
@@ -11,19 +11,73 @@
 #include "GammaMatrix.hpp"
 #include "Gamma.hpp"
 
+#include <algorithm>
+
 namespace dirac {
 
 namespace algebra {
 
-const std::string GammaBasis::gamma = "\\gamma";
-const std::string GammaBasis::sigma = "\\sigma";
-const std::string GammaBasis::gamma5 = "\\gamma5";
+const Symbol GammaBasis::gamma{ "\\gamma" };
+const Symbol GammaBasis::sigma{ "\\sigma" };
+const Symbol GammaBasis::gamma5{ "\\gamma5" };
+
+//----------------------------------------------------------------------
+
+GammaWordShape::GammaWordShape(std::span<const GammaTensor> word) {
+	for (const GammaTensor& factor : word) {
+		if (GammaBasis::gamma == factor.id())
+			_codes.push_back(1);
+		else if (GammaBasis::sigma == factor.id())
+			_codes.push_back(2);
+		else
+			_codes.push_back(3);
+
+		for (const TensorIndex& idx : factor.indices()) {
+			IndexId id = idx.id();
+			if (id.isTag())
+				_cacheable = false;
+
+			auto found = std::find(_labels.begin(), _labels.end(), id);
+			std::uint32_t ordinal = found - _labels.begin();
+			if (found == _labels.end())
+				_labels.push_back(id);
+
+			_codes.push_back((ordinal << 1) | (idx.isUpper() ? 1 : 0));
+		}
+	}
+}
+
+//----------------------------------------------------------------------
 
-const GammaBasis::NameSet GammaBasis::Elements{
-	GammaBasis::gamma,
-	GammaBasis::gamma5,
-	GammaBasis::sigma
-};
+std::vector<GammaTensor>
+GammaWordShape::placeholders(std::span<const GammaTensor> word) const {
+	std::vector<GammaTensor> res;
+	res.reserve(word.size());
+	for (const GammaTensor& factor : word) {
+		GammaTensor::Indices indices;
+		for (const TensorIndex& idx : factor.indices()) {
+			int ordinal = std::find(_labels.begin(), _labels.end(), idx.id())
+							- _labels.begin();
+			indices.push_back(TensorIndex{
+				IndexTag{ placeholderTag, ordinal }, idx.isUpper() });
+		}
+
+		res.push_back(GammaTensor::create(factor.id(), indices));
+	}
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+size_t GammaWordShape::Hash::operator()(const GammaWordShape& shape) const {
+	size_t value = shape._codes.size();
+	for (std::uint32_t code : shape._codes)
+		value ^= std::hash<std::uint32_t>{}(code) + 0x9e3779b9
+					+ (value << 6) + (value >> 2);
+
+	return value;
+}
 
 }
 
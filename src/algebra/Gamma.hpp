@@ -12,11 +12,19 @@
 
 #include "TensorBase.hpp"
 #include "LorentzInvariant.hpp"
+#include "Symbol.hpp"
 #include <string>
 #include <unordered_set>
 #include "Polynomials.hpp"
 #include <ostream>
 #include <vector>
+#include <array>
+#include <list>
+#include <span>
+#include <unordered_map>
+#include <cstdint>
+#include <optional>
+#include <algorithm>
 #include "GammaMatrix.hpp"
 
 namespace dirac {
@@ -31,26 +39,28 @@ namespace algebra {
 struct GammaBasis {
 	GammaBasis() = default;
 
-	static const std::string gamma;
-	static const std::string sigma;
-	static const std::string gamma5;
+	static const Symbol gamma;
+	static const Symbol sigma;
+	static const Symbol gamma5;
 
-	using NameSet = std::unordered_set<std::string>;
-	static const NameSet Elements;
+	/**
+	 * Maximum number of indices over all basis elements
+	 */
+	static constexpr size_t indexCapacity = LI::Basis::indexCapacity;
 
 	/**
 	 * Returns true if the argument identifies one of basis elements,
 	 * false otherwise
 	 */
-	inline static bool allows(const std::string& id) {
+	inline static bool allows(const Symbol& id) {
 		return (LI::Basis::allows(id)
-				|| (Elements.find(id) != Elements.end()));
+				|| (id == gamma) || (id == sigma) || (id == gamma5));
 	}
 
 	/**
 	 * Maximum number of indices that a basis element can have
 	 */
-	inline static size_t maxIndexCount(const std::string& id) {
+	inline static size_t maxIndexCount(const Symbol& id) {
 		if (LI::Basis::allows(id))
 			return LI::Basis::maxIndexCount(id);
 
@@ -62,13 +72,26 @@ struct GammaBasis {
 
 		return 0;
 	}
+
+	/**
+	 * Index symmetry of a basis element
+	 */
+	inline static IndexSymmetry symmetry(const Symbol& id) {
+		if (LI::Basis::allows(id))
+			return LI::Basis::symmetry(id);
+
+		if (id == sigma)
+			return IndexSymmetry::Antisymmetric;
+
+		return IndexSymmetry::None;
+	}
 };
 
 /**
  * Basis element of the gamma ring
  */
 using GammaTensor =
-		TensorBase<std::string, GammaBasis, IndexId>;
+		TensorBase<Symbol, GammaBasis, IndexId>;
 
 /**
  * Gamma-ring element, that is, a polynomial of
@@ -173,6 +196,457 @@ GammaPolynomial<Scalar> toPolynomial(const GammaTensor& t) {
 
 //----------------------------------------------------------------------
 
+/**
+ * Shape of a word of Dirac matrices: ids of its factors
+ * and positions of their indices, with index labels replaced
+ * by ordinals of their first occurrences.
+ * Words of the same shape differ only in index labels,
+ * so their pseudo-vectors differ only in index labels as well.
+ */
+class GammaWordShape {
+public:
+	/**
+	 * Tag of placeholder labels, see placeholders()
+	 */
+	static constexpr int placeholderTag = IndexId::minTag + 4;
+
+	/**
+	 * Shape of the argument, whose factors must be complete
+	 * Dirac matrices
+	 */
+	explicit GammaWordShape(std::span<const GammaTensor> word);
+
+	/**
+	 * Distinct index labels of the word in order of first occurrence
+	 */
+	const std::vector<IndexId>& labels() const { return _labels; }
+
+	/**
+	 * Returns false if some labels of the word are tags.
+	 * Such labels may coincide with index templates of reduceGamma,
+	 * so words containing them are not cached.
+	 */
+	bool isCacheable() const { return _cacheable; }
+
+	/**
+	 * Copy of the word with each label replaced by the placeholder
+	 * {placeholderTag, ordinal}
+	 */
+	std::vector<GammaTensor>
+	placeholders(std::span<const GammaTensor> word) const;
+
+	bool operator==(const GammaWordShape& other) const {
+		return (_codes == other._codes);
+	}
+
+	struct Hash {
+		size_t operator()(const GammaWordShape& shape) const;
+	};
+
+private:
+	/**
+	 * Factor ids followed by their indices' ordinals and positions
+	 */
+	std::vector<std::uint32_t> _codes;
+
+	std::vector<IndexId> _labels;
+	bool _cacheable = true;
+};
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-matrix of a Dirac matrix with index templates
+ * tagged by the second and third arguments
+ */
+template<typename Scalar>
+SparseGammaMatrix<Scalar> pseudoMatrix(const GammaTensor& factor,
+										int leftTag, int rightTag) {
+	const GammaTensor::Indices& indices = factor.indices();
+	if (GammaBasis::gamma == factor.id())
+		return gamma<Scalar>(indices[0], leftTag, rightTag);
+
+	if (GammaBasis::sigma == factor.id())
+		return sigma<Scalar>(indices[0], indices[1], leftTag, rightTag);
+
+	return gamma5<Scalar>(leftTag, rightTag);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-vector of a word of Dirac matrices, that is,
+ * the first column of the product of the factors' pseudo-matrices.
+ * Index templates of the product are tagged 0, 1, ..., word.size().
+ */
+template<typename Scalar>
+GammaVector<Scalar> multiplyWord(std::span<const GammaTensor> word) {
+	//Multiply terms from right to left
+	int gammaCount = word.size();
+	GammaVector<Scalar> res =
+			pseudoMatrix<Scalar>(word.back(), gammaCount - 1, gammaCount)
+				.col(0);
+	for (--gammaCount; gammaCount > 0; --gammaCount)
+		res = pseudoMatrix<Scalar>(word[gammaCount - 1],
+						gammaCount - 1, gammaCount) * res;
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Least recently used cache of word pseudo-vectors keyed by word shape.
+ * Pseudo-vectors are stored with placeholder labels
+ * and renamed on lookup. Stored polynomials do not use
+ * the default memory resource, so the cache may outlive
+ * the current EvaluationArena.
+ *
+ * The cache is not thread-safe: an instance must only be used
+ * by a single thread, see reduceWord.
+ */
+template<typename Scalar>
+class GammaWordCache {
+public:
+	/**
+	 * Maximum number of cached shapes
+	 */
+	static constexpr size_t capacity = 1024;
+
+	/**
+	 * Pseudo-vector of the word, which must have the given shape,
+	 * see multiplyWord
+	 */
+	GammaVector<Scalar> reduce(const GammaWordShape& shape,
+								std::span<const GammaTensor> word);
+
+private:
+	/**
+	 * Pseudo-vectors are only stored for shapes seen more than once,
+	 * since renaming costs more than multiplication for unique words
+	 */
+	using Entry = std::pair<GammaWordShape,
+							std::optional<GammaVector<Scalar>>>;
+	using Entries = std::list<Entry>;
+
+	/**
+	 * Entries from the most to the least recently used one
+	 */
+	Entries _entries;
+
+	std::unordered_map<GammaWordShape, typename Entries::iterator,
+						GammaWordShape::Hash> _index;
+};
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+GammaVector<Scalar>
+GammaWordCache<Scalar>::reduce(const GammaWordShape& shape,
+								std::span<const GammaTensor> word) {
+	auto found = _index.find(shape);
+	if (found == _index.end()) {
+		_entries.emplace_front(shape, std::nullopt);
+		_index.emplace(shape, _entries.begin());
+		if (_entries.size() > capacity) {
+			_index.erase(_entries.back().first);
+			_entries.pop_back();
+		}
+
+		return multiplyWord<Scalar>(word);
+	}
+
+	_entries.splice(_entries.begin(), _entries, found->second);
+	std::optional<GammaVector<Scalar>>& stored = _entries.front().second;
+	if (!stored) {
+		DefaultResourceScope scope{ std::pmr::new_delete_resource() };
+		stored = multiplyWord<Scalar>(shape.placeholders(word));
+	}
+
+	const std::vector<IndexId>& labels = shape.labels();
+	GammaVector<Scalar> res{ *stored };
+	for (unsigned int i = 0; i < 5; ++i) {
+		LI::TensorPolynomial<Scalar>& element = res(i);
+		if (element.terms.empty())
+			continue;
+
+		for (const auto& term : element.terms)
+			for (LI::Tensor& factor : term.factors) {
+				const LI::Tensor::Indices& indices = factor.indices();
+				for (size_t j = 0; j < indices.size(); ++j) {
+					IndexId id = indices[j].id();
+					if (id.isTag()
+							&& (id.tag().first
+									== GammaWordShape::placeholderTag))
+						factor.replaceIndex(j,
+								TensorIndex{ labels[id.tag().second],
+												indices[j].isUpper() });
+				}
+			}
+
+		element.sortTerms();
+	}
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-vector of a word of Dirac matrices, see multiplyWord.
+ * Words of recently seen shapes are taken from the cache.
+ * Each thread has its own cache, so words may be reduced
+ * concurrently, e.g. inside parallelFor.
+ */
+template<typename Scalar>
+GammaVector<Scalar> reduceWord(std::span<const GammaTensor> word) {
+	GammaWordShape shape{ word };
+	if (!shape.isCacheable())
+		return multiplyWord<Scalar>(word);
+
+	thread_local GammaWordCache<Scalar> cache;
+	return cache.reduce(shape, word);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Applies contraction identities of Dirac matrices to a word in place:
+ * - \gamma^\mu X \gamma_\mu for X = 1, \gamma^\nu,
+ *   \gamma^\nu\gamma^\rho, \gamma^\nu\gamma^\rho\gamma^\sigma,
+ *   \gamma^5, \sigma^{\nu\rho};
+ * - \sigma^{\mu\nu} X \sigma_{\mu\nu} for X = 1, \gamma^\rho,
+ *   \gamma^5, \sigma^{\rho\tau};
+ * - \gamma_\mu\sigma^{\mu\nu} and \sigma^{\mu\nu}\gamma_\nu.
+ * Only labels occurring exactly twice in the term, as an upper
+ * and a lower index, are contracted. The second argument holds
+ * Lorentz-invariant factors of the term; metric factors
+ * produced by contractions are appended to it.
+ * Returns the numeric factor of the rewritten term,
+ * zero if the term vanishes.
+ */
+template<typename Scalar>
+Complex<Scalar> contractWord(std::vector<GammaTensor>& word,
+							std::vector<LI::Tensor>& coeffFactors) {
+	auto occurrences = [&](const IndexId& id) {
+		size_t count = 0;
+		for (const GammaTensor& factor : word)
+			for (const TensorIndex& idx : factor.indices())
+				count += (idx.id() == id) ? 1 : 0;
+
+		for (const LI::Tensor& factor : coeffFactors)
+			for (const TensorIndex& idx : factor.indices())
+				count += (idx.id() == id) ? 1 : 0;
+
+		return count;
+	};
+
+	auto contracted = [&](const TensorIndex& i1, const TensorIndex& i2) {
+		return (i1.id() == i2.id()) && (i1.isUpper() != i2.isUpper())
+				&& (occurrences(i1.id()) == 2);
+	};
+
+	auto number = [](int n) {
+		return Complex<Scalar>{ static_cast<Scalar>(n) };
+	};
+
+	auto isGamma = [](const GammaTensor& t) {
+		return (GammaBasis::gamma == t.id());
+	};
+
+	auto gammaOf = [](const TensorIndex& idx) {
+		return GammaTensor::create(GammaBasis::gamma,
+									GammaTensor::Indices{ idx });
+	};
+
+	const Complex<Scalar> threeI = I<Scalar>() * number(3);
+
+	Complex<Scalar> res = one<Scalar>();
+
+	//Rewrites word[first, last] as the replacement
+	//and multiplies the result by the factor
+	auto rewrite = [&](size_t first, size_t last,
+						std::vector<GammaTensor> replacement,
+						const Complex<Scalar>& factor) {
+		word.erase(word.begin() + first, word.begin() + last + 1);
+		word.insert(word.begin() + first,
+				replacement.begin(), replacement.end());
+		res = res * factor;
+	};
+
+	//Tries contracting the word's factors at the given positions
+	auto contract = [&](size_t first, size_t last) {
+		const GammaTensor& left = word[first];
+		const GammaTensor& right = word[last];
+		std::vector<GammaTensor> inner(word.begin() + first + 1,
+										word.begin() + last);
+
+		bool innerGammas = std::all_of(inner.begin(), inner.end(), isGamma);
+		bool innerGamma5 = (inner.size() == 1)
+							&& (GammaBasis::gamma5 == inner[0].id());
+		bool innerSigma = (inner.size() == 1)
+							&& (GammaBasis::sigma == inner[0].id());
+
+		if (isGamma(left) && isGamma(right)) {
+			if (!contracted(left.indices()[0], right.indices()[0]))
+				return false;
+
+			if (innerGamma5) {
+				rewrite(first, last, inner, number(-4));
+				return true;
+			}
+
+			if (innerSigma) {
+				res = zero<Scalar>();
+				return true;
+			}
+
+			if (!innerGammas)
+				return false;
+
+			switch (inner.size()) {
+			case 0:
+				rewrite(first, last, inner, number(4));
+				return true;
+			case 1:
+				rewrite(first, last, inner, number(-2));
+				return true;
+			case 2: {
+				const TensorIndex& nu = inner[0].indices()[0];
+				const TensorIndex& rho = inner[1].indices()[0];
+				coeffFactors.push_back(LI::Tensor::create(
+						(nu.isUpper() == rho.isUpper())
+							? LI::Basis::eta : LI::Basis::delta,
+						LI::Tensor::Indices{ nu, rho }));
+				rewrite(first, last, {}, number(4));
+				return true;
+			}
+			case 3:
+				std::reverse(inner.begin(), inner.end());
+				rewrite(first, last, inner, number(-2));
+				return true;
+			default:
+				return false;
+			}
+		}
+
+		if ((GammaBasis::sigma == left.id())
+				&& (GammaBasis::sigma == right.id())) {
+			const GammaTensor::Indices& l = left.indices();
+			const GammaTensor::Indices& r = right.indices();
+			int sign = 0;
+			if (contracted(l[0], r[0]) && contracted(l[1], r[1]))
+				sign = 1;
+			else if (contracted(l[0], r[1]) && contracted(l[1], r[0]))
+				sign = -1;
+			else
+				return false;
+
+			if (inner.empty() || innerGamma5)
+				rewrite(first, last, inner, number(12 * sign));
+			else if (innerSigma)
+				rewrite(first, last, inner, number(-4 * sign));
+			else if ((inner.size() == 1) && innerGammas)
+				res = zero<Scalar>();
+			else
+				return false;
+
+			return true;
+		}
+
+		if (last != first + 1)
+			return false;
+
+		if (isGamma(left) && (GammaBasis::sigma == right.id())) {
+			const TensorIndex& mu = left.indices()[0];
+			const GammaTensor::Indices& r = right.indices();
+			if (contracted(mu, r[0]))
+				rewrite(first, last, { gammaOf(r[1]) }, threeI);
+			else if (contracted(mu, r[1]))
+				rewrite(first, last, { gammaOf(r[0]) }, -threeI);
+			else
+				return false;
+
+			return true;
+		}
+
+		if ((GammaBasis::sigma == left.id()) && isGamma(right)) {
+			const GammaTensor::Indices& l = left.indices();
+			const TensorIndex& nu = right.indices()[0];
+			if (contracted(l[1], nu))
+				rewrite(first, last, { gammaOf(l[0]) }, threeI);
+			else if (contracted(l[0], nu))
+				rewrite(first, last, { gammaOf(l[1]) }, -threeI);
+			else
+				return false;
+
+			return true;
+		}
+
+		return false;
+	};
+
+	//Identities are applied until none matches,
+	//innermost contractions first
+	bool changed = true;
+	while (changed && (res != zero<Scalar>())) {
+		changed = false;
+		for (size_t length = 1; (length <= 4) && !changed; ++length)
+			for (size_t first = 0;
+					(first + length < word.size()) && !changed; ++first)
+				changed = contract(first, first + length);
+	}
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Splits a gamma polynomial term into the word of its Dirac matrices,
+ * which is stored in the second argument, and the Lorentz-invariant
+ * coefficient, which is returned. Contracted indices of the word
+ * are eliminated, see contractWord.
+ * Throws std::runtime_error if a Dirac matrix is incomplete or unknown.
+ */
+template<typename Scalar>
+LI::TensorPolynomial<Scalar>
+splitTerm(const typename GammaPolynomial<Scalar>::Term& term,
+			std::vector<GammaTensor>& word) {
+	word.clear();
+	std::vector<LI::Tensor> coeffFactors;
+	for (const GammaTensor& factor : term.factors) {
+		if (LI::Basis::allows(factor.id()))
+			coeffFactors.push_back(LI::Tensor::create(factor.id(),
+					factor.indices()));
+		else {
+			if (!factor.complete())
+				throw std::runtime_error{
+					"Not enough indices for " + factor.id().str() };
+
+			if ((GammaBasis::gamma != factor.id())
+					&& (GammaBasis::sigma != factor.id())
+					&& (GammaBasis::gamma5 != factor.id()))
+				throw std::runtime_error{
+					"Unknown tensor name: " + factor.id().str() };
+
+			word.push_back(factor);
+		}
+	}
+
+	Complex<Scalar> value = term.coeff;
+	if (value != zero<Scalar>())
+		value = value * contractWord<Scalar>(word, coeffFactors);
+
+	LI::TensorPolynomial<Scalar> coeff;
+	if (value != zero<Scalar>())
+		coeff.terms.append(value, coeffFactors);
+
+	return coeff;
+}
+
+//----------------------------------------------------------------------
+
 /**
  * Transforms an arbitrary gamma polynomial to canonical form
  * by expanding products of \gamma matrices.
@@ -183,61 +657,158 @@ CanonicalExpr<Scalar> reduceGamma(const GammaPolynomial<Scalar>& p) {
 
 	CanonicalExpr<Scalar> expr;
 
-	for (const typename GammaPolynomial<Scalar>::Term& term : p.terms) {
-		LI::TensorPolynomial<Scalar> coeff{ term.coeff };
-		coeff.terms[0].factors.reserve(term.factors.size());
-
-		//Build coefficient and the list of terms
-		int gammaCount = 0;
-		std::vector<GammaMatrix<Scalar>> factorsRepr;
-		factorsRepr.reserve(term.factors.size());
-		for (const GammaTensor& factor : term.factors) {
-			if (LI::Basis::allows(factor.id()))
-				coeff *= LI::Tensor::create(factor.id(),
-						factor.indices());
-			else {
-				if (!factor.complete())
-					throw std::runtime_error{
-						"Not enough indices for " + factor.id() };
-
-				int nextCount = gammaCount + 1;
-				const TensorIndices& indices = factor.indices();
-				if (GammaBasis::gamma == factor.id())
-					factorsRepr.push_back(
-							gamma<Scalar>(indices[0],
-									gammaCount, nextCount));
-				else if (GammaBasis::sigma == factor.id())
-					factorsRepr.push_back(
-							sigma<Scalar>(indices[0],
-									indices[1],
-									gammaCount,
-									nextCount));
-				else if (GammaBasis::gamma5 == factor.id())
-					factorsRepr.push_back(
-							gamma5<Scalar>(gammaCount, nextCount));
-				else
-					throw std::runtime_error{
-						"Unknown tensor name: " + factor.id() };
-
-				gammaCount = nextCount;
+	//Coefficients are canonicalized once, after all terms are summed
+	std::array<PolynomialBuilder<LI::TensorPolynomial<Scalar>>, 5> sums;
+
+	std::vector<GammaTensor> word;
+	for (const auto& term : p.terms) {
+		LI::TensorPolynomial<Scalar> coeff = splitTerm<Scalar>(term, word);
+		if (word.empty())
+			sums[0] += std::move(coeff);
+		else {
+			GammaVector<Scalar> termRepr = reduceWord<Scalar>(word);
+			for (unsigned int i = 0; i < 5; ++i)
+				sums[i].addProduct(coeff, termRepr(i));
+		}
+	}
+
+	for (unsigned int i = 0; i < 5; ++i)
+		expr.coeffs(i) = sums[i].finalize();
+
+	return expr;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Renames index templates of a pseudo-vector's basis matrices
+ * from the second argument's tag to the third argument's tag
+ */
+template<typename Scalar>
+void renameTemplates(GammaVector<Scalar>& v, int from, int to) {
+	for (unsigned int i = 0; i < 5; ++i) {
+		LI::TensorPolynomial<Scalar>& element = v(i);
+		if (element.terms.empty())
+			continue;
+
+		for (const auto& term : element.terms)
+			for (LI::Tensor& factor : term.factors) {
+				const LI::Tensor::Indices& indices = factor.indices();
+				for (size_t j = 0; j < indices.size(); ++j) {
+					IndexId id = indices[j].id();
+					if (id.isTag() && (id.tag().first == from))
+						factor.replaceIndex(j,
+								TensorIndex{ IndexTag{ to, id.tag().second },
+												indices[j].isUpper() });
+				}
 			}
+
+		element.sortTerms();
+	}
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Left multiplication of a pseudo-vector by a gamma polynomial.
+ * Terms with Dirac matrices are first summed into the polynomial's
+ * pseudo-matrix, which is then applied to the vector, so each vector
+ * component is multiplied once per nonzero matrix element
+ * rather than once per term.
+ *
+ * Index templates of the argument's basis matrices must be tagged
+ * 0 or 1; the result's ones are tagged with the other tag.
+ * Templates of intermediate products are tagged 2, 3, ...
+ */
+template<typename Scalar>
+GammaVector<Scalar> leftMultiply(const GammaPolynomial<Scalar>& p,
+								const GammaVector<Scalar>& v,
+								int vectorTag) {
+	using Builder = PolynomialBuilder<LI::TensorPolynomial<Scalar>>;
+	int resultTag = 1 - vectorTag;
+
+	std::array<Builder, 5> sums;
+	std::array<std::array<Builder, 5>, 5> matrix;
+	std::optional<GammaVector<Scalar>> renamed;
+	std::vector<GammaTensor> word;
+	for (const auto& term : p.terms) {
+		LI::TensorPolynomial<Scalar> coeff = splitTerm<Scalar>(term, word);
+		if (word.empty()) {
+			if (!renamed) {
+				renamed.emplace(v);
+				renameTemplates<Scalar>(*renamed, vectorTag, resultTag);
+			}
+
+			for (unsigned int i = 0; i < 5; ++i)
+				sums[i].addProduct(coeff, (*renamed)(i));
+
+			continue;
 		}
 
-		//Multiply terms from right to left
-		if (factorsRepr.empty())
-			expr.coeffs += GammaVector<Scalar>{ coeff,
-				LI::ZeroPoly<Scalar>(), LI::ZeroPoly<Scalar>(),
-				LI::ZeroPoly<Scalar>(), LI::ZeroPoly<Scalar>() };
-		else {
-			GammaVector<Scalar> termRepr = factorsRepr.back().col(0);
-			for (auto iFactor = factorsRepr.rbegin() + 1;
-					iFactor != factorsRepr.rend(); ++iFactor)
-				termRepr = (*iFactor) * termRepr;
+		//Only the columns multiplying nonzero vector components
+		//are needed
+		for (unsigned int col = 0; col < 5; ++col) {
+			if (v(col).terms.empty())
+				continue;
+
+			//Multiply terms from right to left
+			int rightTag = (word.size() > 1)
+					? static_cast<int>(word.size()) : resultTag;
+			GammaVector<Scalar> column =
+					pseudoMatrix<Scalar>(word.back(), rightTag, vectorTag)
+						.col(col);
+			for (size_t i = word.size() - 1; i > 0; --i) {
+				int leftTag = (i > 1) ? static_cast<int>(i) : resultTag;
+				column = pseudoMatrix<Scalar>(word[i - 1],
+								leftTag, rightTag) * column;
+				rightTag = leftTag;
+			}
+
+			for (unsigned int row = 0; row < 5; ++row)
+				matrix[row][col].addProduct(coeff, column(row));
+		}
+	}
 
-			expr.coeffs += coeff * termRepr;
+	for (unsigned int row = 0; row < 5; ++row)
+		for (unsigned int col = 0; col < 5; ++col) {
+			LI::TensorPolynomial<Scalar> element = matrix[row][col].finalize();
+			if (!element.terms.empty())
+				sums[row].addProduct(element, v(col));
 		}
+
+	GammaVector<Scalar> res;
+	for (unsigned int i = 0; i < 5; ++i)
+		res(i) = sums[i].finalize();
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Transforms a product of gamma polynomials to canonical form
+ * without expanding it. The last factor is reduced by reduceGamma,
+ * and the others are applied to the result from right to left,
+ * so the cost grows linearly with the number of factors
+ * rather than with the number of terms of the expanded product.
+ */
+template<typename Scalar>
+CanonicalExpr<Scalar>
+reduceProduct(std::span<const GammaPolynomial<Scalar>> factors) {
+	if (factors.empty())
+		throw std::runtime_error{ "Empty product" };
+
+	CanonicalExpr<Scalar> expr = reduceGamma<Scalar>(factors.back());
+	int vectorTag = 0;
+	for (size_t i = factors.size() - 1; i > 0; --i) {
+		expr.coeffs = leftMultiply<Scalar>(factors[i - 1], expr.coeffs,
+											vectorTag);
+		vectorTag = 1 - vectorTag;
 	}
 
+	if (vectorTag != 0)
+		renameTemplates<Scalar>(expr.coeffs, vectorTag, 0);
+
 	return expr;
 }
 
@@ -254,6 +825,17 @@ operator+(const GammaPolynomial<Scalar>& p1,
 
 //----------------------------------------------------------------------
 
+//Gamma polynomial sum reusing the left operand
+template<typename Scalar>
+inline GammaPolynomial<Scalar>
+operator+(GammaPolynomial<Scalar>&& p1,
+		const GammaPolynomial<Scalar>& p2) {
+	return sum<GammaPolynomial<Scalar>,
+			Complex<Scalar>, GammaTensor>(std::move(p1), p2);
+}
+
+//----------------------------------------------------------------------
+
 //Gamma polynomial difference
 template<typename Scalar>
 inline GammaPolynomial<Scalar>
@@ -265,6 +847,17 @@ operator-(const GammaPolynomial<Scalar>& p1,
 
 //----------------------------------------------------------------------
 
+//Gamma polynomial difference reusing the left operand
+template<typename Scalar>
+inline GammaPolynomial<Scalar>
+operator-(GammaPolynomial<Scalar>&& p1,
+		const GammaPolynomial<Scalar>& p2) {
+	return diff<GammaPolynomial<Scalar>,
+			Complex<Scalar>, GammaTensor>(std::move(p1), p2);
+}
+
+//----------------------------------------------------------------------
+
 //Gamma polynomial negation (unary minus) operator
 template<typename Scalar>
 inline GammaPolynomial<Scalar>
@@ -275,6 +868,16 @@ operator-(const GammaPolynomial<Scalar>& p) {
 
 //----------------------------------------------------------------------
 
+//In-place negation of a temporary gamma polynomial
+template<typename Scalar>
+inline GammaPolynomial<Scalar>
+operator-(GammaPolynomial<Scalar>&& p) {
+	return negate<GammaPolynomial<Scalar>,
+			Complex<Scalar>, GammaTensor>(std::move(p));
+}
+
+//----------------------------------------------------------------------
+
 //Product of gamma polynomials
 template<typename Scalar>
 inline GammaPolynomial<Scalar>
@@ -297,6 +900,17 @@ operator*(const Complex<Scalar>& c,
 
 //----------------------------------------------------------------------
 
+//In-place left multiplication of a temporary gamma polynomial
+template<typename Scalar>
+inline GammaPolynomial<Scalar>
+operator*(const Complex<Scalar>& c,
+		GammaPolynomial<Scalar>&& p) {
+	return prod<GammaPolynomial<Scalar>,
+			Complex<Scalar>, GammaTensor>(c, std::move(p));
+}
+
+//----------------------------------------------------------------------
+
 //Right multiplication of a gamma polynomial by a complex number
 template<typename Scalar>
 inline GammaPolynomial<Scalar>
@@ -308,30 +922,40 @@ operator*(const GammaPolynomial<Scalar>& p,
 
 //----------------------------------------------------------------------
 
+//In-place right multiplication of a temporary gamma polynomial
+template<typename Scalar>
+inline GammaPolynomial<Scalar>
+operator*(GammaPolynomial<Scalar>&& p,
+		const Complex<Scalar>& c) {
+	return prod<GammaPolynomial<Scalar>,
+			Complex<Scalar>, GammaTensor>(std::move(p), c);
+}
+
+//----------------------------------------------------------------------
+
 template<typename Scalar>
 void CanonicalExpr<Scalar>::applySymmetry() {
-	using Term = typename LI::TensorPolynomial<Scalar>::Term;
-	coeffs(2).mergeTerms(
-			[&](const Term& t1, const Term& t2) -> std::optional<Term> {
-				Term swapped{ t2 };
-				swapped.coeff = -swapped.coeff;
+	using TermRef = typename LI::TensorPolynomial<Scalar>::TermRef;
+	TensorIndex i1{ this->tensorIndices.first.id(),
+					!this->tensorIndices.first.isUpper() };
+	TensorIndex i2{ this->tensorIndices.second.id(),
+					!this->tensorIndices.second.isUpper() };
+
+	//Terms are merged with the ones differing by the sign
+	//and the order of antisymmetric indices
+	coeffs(2).mergeMapped(
+			[&](const TermRef& term) {
+				term.coeff = -term.coeff;
 
 				//Swap indices
-				TensorIndex i1{ this->tensorIndices.first.id,
-								!this->tensorIndices.first.isUpper };
-				TensorIndex i2{ this->tensorIndices.second.id,
-								!this->tensorIndices.second.isUpper };
-				for (LI::Tensor& factor : swapped.factors) {
-					const TensorIndices& indices = factor.indices();
+				for (LI::Tensor& factor : term.factors) {
+					const GammaTensor::Indices& indices = factor.indices();
 					for (size_t i = 0; i < indices.size(); ++i)
 						if (indices[i] == i1)
 							factor.replaceIndex(i, i2);
 						else if (indices[i] == i2)
 							factor.replaceIndex(i, i1);
 				}
-
-				return LI::TensorPolynomial<Scalar>::tryMerge(
-														t1, swapped);
 			});
 }
 
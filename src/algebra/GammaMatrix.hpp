@@ -12,8 +12,14 @@
 
 #include <Eigen>
 #include "LorentzInvariant.hpp"
+#include "Arena.hpp"
 #include <utility>
 #include <optional>
+#include <span>
+#include <array>
+#include <memory_resource>
+#include <vector>
+#include <stdexcept>
 
 namespace Eigen {
 
@@ -59,12 +65,146 @@ template<typename Scalar>
 using GammaVector = Eigen::Matrix<LI::TensorPolynomial<Scalar>, 5, 1>;
 
 /**
- * Pseudo-matrix representation of \gamma^\mu.
+ * Brings pseudo-matrix elements to sorted form,
+ * so that sums in pseudo-matrix products are computed by merging,
+ * see LI::TensorPolynomial::sortTerms
+ */
+template<typename Scalar>
+void sortElements(GammaMatrix<Scalar>& m) {
+	for (Eigen::Index i = 0; i < m.size(); ++i)
+		m(i).sortTerms();
+}
+
+/**
+ * Position of a nonzero pseudo-matrix element.
+ * Rows and columns are grades of Dirac matrix basis elements:
+ * 1, \gamma, \sigma, \gamma^5\gamma and \gamma^5.
+ */
+struct GammaEntry {
+	unsigned int row;
+	unsigned int col;
+};
+
+/**
+ * Sparsity patterns of pseudo-matrices in row-major order.
+ * \gamma shifts the grade by one, \sigma by zero or two,
+ * \gamma^5 maps grade k to 4 - k.
+ */
+inline constexpr std::array<GammaEntry, 8> gammaPattern{ {
+	{ 0, 1 }, { 1, 0 }, { 1, 2 }, { 2, 1 },
+	{ 2, 3 }, { 3, 2 }, { 3, 4 }, { 4, 3 } } };
+
+inline constexpr std::array<GammaEntry, 5> gamma5Pattern{ {
+	{ 0, 4 }, { 1, 3 }, { 2, 2 }, { 3, 1 }, { 4, 0 } } };
+
+inline constexpr std::array<GammaEntry, 9> sigmaPattern{ {
+	{ 0, 2 }, { 1, 1 }, { 1, 3 }, { 2, 0 }, { 2, 2 },
+	{ 2, 4 }, { 3, 1 }, { 3, 3 }, { 4, 2 } } };
+
+/**
+ * Sparse pseudo-matrix: elements at the positions
+ * of a fixed sparsity pattern, the rest being zero.
+ * Zero elements are neither stored nor multiplied.
+ */
+template<typename Scalar>
+class SparseGammaMatrix {
+public:
+	/**
+	 * Collects the elements of a dense pseudo-matrix
+	 * at pattern positions. The pattern must outlive the instance.
+	 * Throws std::runtime_error if a nonzero element
+	 * is not in the pattern.
+	 */
+	SparseGammaMatrix(std::span<const GammaEntry> pattern,
+						const GammaMatrix<Scalar>& dense);
+
+	/**
+	 * Left multiplication of a pseudo-vector.
+	 * Only nonzero vector components are multiplied, so words
+	 * of Dirac matrices are multiplied grade by grade:
+	 * e.g. vectors of odd words have no scalar component.
+	 */
+	GammaVector<Scalar> operator*(const GammaVector<Scalar>& v) const;
+
+	/**
+	 * Column of the pseudo-matrix, that is, the pseudo-vector
+	 * of the product of the Dirac matrix and a basis element
+	 */
+	GammaVector<Scalar> col(unsigned int index) const;
+
+	/**
+	 * Elements at pattern positions
+	 */
+	std::span<LI::TensorPolynomial<Scalar>> values() { return _values; }
+
+	std::span<const LI::TensorPolynomial<Scalar>> values() const {
+		return _values;
+	}
+
+private:
+	std::span<const GammaEntry> _pattern;
+	std::vector<LI::TensorPolynomial<Scalar>> _values;
+};
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+SparseGammaMatrix<Scalar>::SparseGammaMatrix(
+		std::span<const GammaEntry> pattern,
+		const GammaMatrix<Scalar>& dense)
+	: _pattern{ pattern } {
+	GammaMatrix<Scalar> rest{ dense };
+	_values.reserve(pattern.size());
+	for (const GammaEntry& entry : pattern) {
+		_values.push_back(dense(entry.row, entry.col));
+		rest(entry.row, entry.col) = LI::TensorPolynomial<Scalar>{};
+	}
+
+	for (Eigen::Index i = 0; i < rest.size(); ++i)
+		if (!rest(i).isZero())
+			throw std::runtime_error{
+				"Pseudo-matrix element outside of sparsity pattern" };
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+GammaVector<Scalar>
+SparseGammaMatrix<Scalar>::operator*(const GammaVector<Scalar>& v) const {
+	//Elements of each row are accumulated in column order,
+	//as in the dense product
+	GammaVector<Scalar> res;
+	for (size_t i = 0; i < _pattern.size(); ++i) {
+		const LI::TensorPolynomial<Scalar>& component = v(_pattern[i].col);
+		if (component.terms.empty() || _values[i].terms.empty())
+			continue;
+
+		res(_pattern[i].row) += _values[i] * component;
+	}
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+GammaVector<Scalar>
+SparseGammaMatrix<Scalar>::col(unsigned int index) const {
+	GammaVector<Scalar> res;
+	for (size_t i = 0; i < _pattern.size(); ++i)
+		if (_pattern[i].col == index)
+			res(_pattern[i].row) = _values[i];
+
+	return res;
+}
+
+/**
+ * Builds pseudo-matrix representation of \gamma^\mu from scratch.
  * First argument is \gamma's tensor index (upper \mu for \gamma^\mu),
  * the rest are templates to construct the rest of pseudo-matrix indices
  */
 template<typename Scalar>
-GammaMatrix<Scalar> gamma(const TensorIndex& mu,
+GammaMatrix<Scalar> makeGamma(const TensorIndex& mu,
 						int leftTag, int rightTag)  {
 	TensorIndex nu{ IndexTag{ rightTag, 0 }, true };
 	TensorIndex nu1{ IndexTag{ rightTag, 1 }, true };
@@ -92,15 +232,16 @@ GammaMatrix<Scalar> gamma(const TensorIndex& mu,
 	res(3, 4) = -eta<Scalar>(mu, lambda);
 	res(4, 3) = -eta<Scalar>(mu, nu);
 
+	sortElements(res);
 	return res;
 }
 
 /**
- * Pseudo-matrix representation of \gamma^5.
+ * Builds pseudo-matrix representation of \gamma^5 from scratch.
  * Arguments are templates for elements tensor indices.
  */
 template<typename Scalar>
-GammaMatrix<Scalar> gamma5(int leftTag, int rightTag) {
+GammaMatrix<Scalar> makeGamma5(int leftTag, int rightTag) {
 	TensorIndex nu{ IndexTag{ rightTag, 0 }, true };
 	TensorIndex nu1{ IndexTag{ rightTag, 1 }, true };
 	TensorIndex nu2{ IndexTag{ rightTag, 2 }, true };
@@ -119,18 +260,19 @@ GammaMatrix<Scalar> gamma5(int leftTag, int rightTag) {
 	res(3, 1) = eta<Scalar>(nu, lambda);
 	res(4, 0) = one<Scalar>();
 
+	sortElements(res);
 	return res;
 }
 
 /**
- * Pseudo-matrix representation of \sigma^{\mu\nu}.
+ * Builds pseudo-matrix representation of \sigma^{\mu\nu} from scratch.
  * First two arguments arre \sigma's tensor indices
  * (upper \mu,\nu for \sigma^{\mu\nu}),
  * the rest are templates to construct coefficients'
  * tensor indices.
  */
 template<typename Scalar>
-GammaMatrix<Scalar> sigma(const TensorIndex& mu1,
+GammaMatrix<Scalar> makeSigma(const TensorIndex& mu1,
 		const TensorIndex& mu2,
 		int leftTag,
 		int rightTag)  {
@@ -189,11 +331,195 @@ GammaMatrix<Scalar> sigma(const TensorIndex& mu1,
 					- eta<Scalar>(mu1, nu) * eta<Scalar>(mu2, lambda));
 	res(4, 2) = - I<Scalar>() * epsilon<Scalar>(mu1, mu2, nu1, nu2);
 
+	sortElements(res);
 	return res;
 }
 
 //----------------------------------------------------------------------
 
+/**
+ * Pseudo-matrix with placeholder tensor indices.
+ * Pseudo-matrices of a Dirac matrix differ only in index names,
+ * so each one is built once with placeholders, cached,
+ * and instantiated for concrete indices by renaming.
+ */
+template<typename Scalar>
+class PseudoMatrixTemplate {
+public:
+	/**
+	 * Placeholder tags of the left and right index templates
+	 * and of the Dirac matrix's own indices;
+	 * slots of the latter are index positions
+	 */
+	static constexpr int leftTag = IndexId::minTag + 1;
+	static constexpr int rightTag = IndexId::minTag + 2;
+	static constexpr int ownTag = IndexId::minTag + 3;
+
+	/**
+	 * Placeholder of the Dirac matrix's i-th index
+	 */
+	static TensorIndex own(int i) {
+		return TensorIndex{ IndexTag{ ownTag, i }, true };
+	}
+
+	/**
+	 * Builds a template with the given sparsity pattern
+	 * from the pseudo-matrix returned by the second argument,
+	 * which is called with the default memory resource replaced,
+	 * so that templates may outlive the current EvaluationArena
+	 */
+	template<typename Builder>
+	static PseudoMatrixTemplate build(std::span<const GammaEntry> pattern,
+										Builder builder) {
+		DefaultResourceScope scope{ std::pmr::new_delete_resource() };
+		return PseudoMatrixTemplate{
+			SparseGammaMatrix<Scalar>{ pattern, builder() } };
+	}
+
+	/**
+	 * Pseudo-matrix with own index placeholders renamed
+	 * to the first argument's elements and index template
+	 * placeholders renamed to the other arguments.
+	 */
+	SparseGammaMatrix<Scalar> instantiate(
+			std::span<const TensorIndex> indices,
+			int left, int right) const;
+
+private:
+	explicit PseudoMatrixTemplate(SparseGammaMatrix<Scalar>&& matrix)
+		: _matrix{ std::move(matrix) } {}
+
+	/**
+	 * Sorted pseudo-matrix with placeholder indices
+	 */
+	SparseGammaMatrix<Scalar> _matrix;
+};
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+SparseGammaMatrix<Scalar> PseudoMatrixTemplate<Scalar>::instantiate(
+		std::span<const TensorIndex> indices, int left, int right) const {
+	auto rename = [&](const TensorIndex& idx) {
+		IndexId id = idx.id();
+		if (!id.isTag())
+			return idx;
+
+		IndexTag tag = id.tag();
+		if (tag.first == leftTag)
+			return TensorIndex{ IndexTag{ left, tag.second }, idx.isUpper() };
+
+		if (tag.first == rightTag)
+			return TensorIndex{ IndexTag{ right, tag.second }, idx.isUpper() };
+
+		if (tag.first != ownTag)
+			return idx;
+
+		const TensorIndex& actual = indices[tag.second];
+		return idx.isUpper() ? actual
+				: TensorIndex{ actual.id(), !actual.isUpper() };
+	};
+
+	//Renaming keeps elements canonical unless actual indices
+	//share labels with each other or with index templates
+	bool clash = false;
+	for (size_t i = 0; i < indices.size(); ++i) {
+		IndexId id = indices[i].id();
+		if (id.isTag() && ((id.tag().first == left)
+							|| (id.tag().first == right)))
+			clash = true;
+
+		for (size_t j = 0; j < i; ++j)
+			if (indices[j].id() == id)
+				clash = true;
+	}
+
+	SparseGammaMatrix<Scalar> res{ _matrix };
+	for (LI::TensorPolynomial<Scalar>& element : res.values()) {
+		//Metric and Kronecker symbols are told apart
+		//by index positions, as in LI::eta
+		for (const auto& term : element.terms)
+			for (LI::Tensor& factor : term.factors) {
+				LI::Tensor::Indices renamed;
+				for (const TensorIndex& idx : factor.indices())
+					renamed.push_back(rename(idx));
+
+				Symbol id = factor.id();
+				if (id != LI::Basis::epsilon)
+					id = (renamed[0].isUpper() == renamed[1].isUpper())
+							? LI::Basis::eta : LI::Basis::delta;
+
+				factor = LI::Tensor::create(id, renamed);
+			}
+
+		if (clash)
+			element.sortTerms();
+		else
+			element.sortCanonicalTerms();
+	}
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-matrix representation of \gamma^\mu,
+ * instantiated from a cached template, see makeGamma
+ */
+template<typename Scalar>
+SparseGammaMatrix<Scalar> gamma(const TensorIndex& mu,
+								int leftTag, int rightTag) {
+	using Template = PseudoMatrixTemplate<Scalar>;
+	static const Template cached = Template::build(gammaPattern, [] {
+		return makeGamma<Scalar>(Template::own(0),
+						Template::leftTag, Template::rightTag);
+	});
+
+	return cached.instantiate(std::span<const TensorIndex>{ &mu, 1 },
+							leftTag, rightTag);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-matrix representation of \gamma^5,
+ * instantiated from a cached template, see makeGamma5
+ */
+template<typename Scalar>
+SparseGammaMatrix<Scalar> gamma5(int leftTag, int rightTag) {
+	using Template = PseudoMatrixTemplate<Scalar>;
+	static const Template cached = Template::build(gamma5Pattern, [] {
+		return makeGamma5<Scalar>(Template::leftTag, Template::rightTag);
+	});
+
+	return cached.instantiate(std::span<const TensorIndex>{},
+							leftTag, rightTag);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Pseudo-matrix representation of \sigma^{\mu\nu},
+ * instantiated from a cached template, see makeSigma
+ */
+template<typename Scalar>
+SparseGammaMatrix<Scalar> sigma(const TensorIndex& mu1,
+		const TensorIndex& mu2,
+		int leftTag,
+		int rightTag) {
+	using Template = PseudoMatrixTemplate<Scalar>;
+	static const Template cached = Template::build(sigmaPattern, [] {
+		return makeSigma<Scalar>(Template::own(0), Template::own(1),
+						Template::leftTag, Template::rightTag);
+	});
+
+	std::array<TensorIndex, 2> indices{ mu1, mu2 };
+	return cached.instantiate(indices, leftTag, rightTag);
+}
+
+//----------------------------------------------------------------------
+
 /**
  * Constructs a diagonal pseudo-matrix
  * with all nonzero elements equal to the argument
@@ -10,26 +10,158 @@
 #ifndef SRC_ALGEBRA_INDEXID_HPP_
 #define SRC_ALGEBRA_INDEXID_HPP_
 
-/*
- * IndexId.hpp
- *
- *  Created on: Dec 17, 2022
- *      Author: skutnii
- */
-
 #include <utility>
-#include <variant>
 #include <string>
+#include <compare>
+#include <cstdint>
+#include <concepts>
+#include <stdexcept>
+#include <functional>
+
+#include "Symbol.hpp"
 
 namespace dirac {
 
 namespace algebra {
 
 /**
- * Tensor index identifier type definition
+ * Generated (dummy) index identifier: a tag and a slot number
  */
 using IndexTag = std::pair<int, int>;
-using IndexId = std::variant<std::string, IndexTag>;
+
+/**
+ * Requirements for an index identifier that can be packed
+ * together with index position into a single 32-bit word.
+ * raw() must leave the top bit clear.
+ */
+template<typename T>
+concept PackedIndexId = requires(const T& id, std::uint32_t raw) {
+	{ id.raw() } -> std::same_as<std::uint32_t>;
+	{ T::fromRaw(raw) } -> std::same_as<T>;
+};
+
+/**
+ * Tensor index identifier.
+ * Either a string label or a generated IndexTag,
+ * packed into the lower 31 bits of a 32-bit word:
+ * - bit 30 is set for tags;
+ * - labels keep their symbol table handle in bits 0-29;
+ * - tags keep the slot in bits 0-7 and the tag in bits 8-29
+ *   (two's complement).
+ * Bit 31 is left for the index position flag (see IndexBase).
+ */
+class IndexId {
+public:
+	static constexpr std::uint32_t tagBit = 1u << 30;
+	static constexpr std::uint32_t valueMask = tagBit - 1;
+	static constexpr unsigned int slotBits = 8;
+	static constexpr std::uint32_t slotMask = (1u << slotBits) - 1;
+	static constexpr unsigned int tagBits = 30 - slotBits;
+
+	/**
+	 * Allowed IndexTag ranges
+	 */
+	static constexpr int minTag = -(1 << (tagBits - 1));
+	static constexpr int maxTag = (1 << (tagBits - 1)) - 1;
+	static constexpr int maxSlot = static_cast<int>(slotMask);
+
+	IndexId(const IndexId& other) = default;
+
+	/**
+	 * Interns a string label
+	 */
+	IndexId(const std::string& label)
+		: _raw{ Symbol{ label }.handle() } {
+		if (_raw > valueMask)
+			throw std::runtime_error{ "Too many index labels" };
+	}
+
+	IndexId(const char* label) : IndexId{ std::string{ label } } {}
+
+	/**
+	 * Packs a generated index identifier.
+	 * Throws std::runtime_error if the tag or the slot is out of range.
+	 */
+	IndexId(const IndexTag& tag) {
+		if ((tag.first < minTag) || (tag.first > maxTag)
+				|| (tag.second < 0) || (tag.second > maxSlot))
+			throw std::runtime_error{ "Index tag out of range" };
+
+		std::uint32_t tagValue =
+				static_cast<std::uint32_t>(tag.first) & (valueMask >> slotBits);
+		_raw = tagBit | (tagValue << slotBits)
+				| static_cast<std::uint32_t>(tag.second);
+	}
+
+	IndexId& operator=(const IndexId& other) = default;
+
+	/**
+	 * Whether the identifier is a generated tag
+	 */
+	bool isTag() const { return (_raw & tagBit) != 0; }
+
+	/**
+	 * Whether the identifier is a string label
+	 */
+	bool isLabel() const { return !isTag(); }
+
+	/**
+	 * Unpacked tag. Only meaningful if isTag() is true.
+	 */
+	IndexTag tag() const {
+		int tagValue = static_cast<int>((_raw & valueMask) >> slotBits);
+		if (tagValue > maxTag)
+			tagValue -= (1 << tagBits);
+
+		return IndexTag{ tagValue, static_cast<int>(_raw & slotMask) };
+	}
+
+	/**
+	 * Label string. Only meaningful if isLabel() is true.
+	 */
+	const std::string& label() const { return Symbol::name(_raw); }
+
+	/**
+	 * Packed representation
+	 */
+	std::uint32_t raw() const { return _raw; }
+
+	/**
+	 * Restores an identifier from its packed representation
+	 */
+	static IndexId fromRaw(std::uint32_t raw) {
+		return IndexId{ raw & (tagBit | valueMask), RawTag{} };
+	}
+
+	bool operator==(const IndexId& other) const = default;
+
+	/**
+	 * Order independent of the order of interning,
+	 * so that sorted output does not depend on earlier input:
+	 * labels go before tags, labels are ordered by their strings,
+	 * tags by tag and slot.
+	 */
+	std::strong_ordering operator<=>(const IndexId& other) const {
+		if (_raw == other._raw)
+			return std::strong_ordering::equal;
+
+		if (isTag() != other.isTag())
+			return isTag() ? std::strong_ordering::greater
+					: std::strong_ordering::less;
+
+		if (isTag())
+			return tag() <=> other.tag();
+
+		return label() <=> other.label();
+	}
+
+private:
+	struct RawTag {};
+
+	IndexId(std::uint32_t raw, RawTag) : _raw{ raw } {}
+
+	std::uint32_t _raw = 0;
+};
 
 } /* namespace dirac */
 
@@ -38,9 +170,9 @@ using IndexId = std::variant<std::string, IndexTag>;
 namespace std {
 
 template<>
-struct hash<dirac::algebra::IndexTag> {
-	size_t operator()(const dirac::algebra::IndexTag& aId) const {
-		return static_cast<size_t>(aId.first ^ aId.second);
+struct hash<dirac::algebra::IndexId> {
+	size_t operator()(const dirac::algebra::IndexId& aId) const {
+		return static_cast<size_t>(aId.raw());
 	}
 };
 
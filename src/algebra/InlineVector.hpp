@@ -0,0 +1,158 @@
+/*
+ * InlineVector.hpp
+ *
+ * Fixed-capacity sequence container with inline storage
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#ifndef SRC_ALGEBRA_INLINEVECTOR_HPP_
+#define SRC_ALGEBRA_INLINEVECTOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <concepts>
+#include <initializer_list>
+#include <ranges>
+
+namespace dirac {
+
+namespace algebra {
+
+/**
+ * Vector-like container holding at most Capacity elements
+ * in place, without heap allocation.
+ * Only trivially copyable element types are supported,
+ * so the container itself is trivially copyable.
+ * Exceeding the capacity throws std::runtime_error.
+ */
+template<typename T, std::size_t Capacity>
+class InlineVector {
+public:
+	static_assert(std::is_trivially_copyable_v<T>,
+			"InlineVector requires trivially copyable elements");
+	static_assert(Capacity <= UINT8_MAX,
+			"InlineVector capacity is too large");
+
+	using value_type = T;
+	using size_type = std::size_t;
+	using reference = T&;
+	using const_reference = const T&;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+	InlineVector() = default;
+	InlineVector(const InlineVector& other) = default;
+
+	InlineVector(std::initializer_list<T> values) {
+		append(values.begin(), values.end(), values.size());
+	}
+
+	/**
+	 * Copies elements from an arbitrary sized range,
+	 * e.g. a std::vector or an InlineVector of different capacity
+	 */
+	template<std::ranges::sized_range Range>
+	requires (!std::same_as<std::remove_cvref_t<Range>, InlineVector>)
+		&& std::convertible_to<std::ranges::range_reference_t<Range>, T>
+	InlineVector(const Range& values) {
+		append(std::ranges::begin(values), std::ranges::end(values),
+				std::ranges::size(values));
+	}
+
+	InlineVector& operator=(const InlineVector& other) = default;
+
+	static constexpr size_type capacity() { return Capacity; }
+
+	size_type size() const { return _size; }
+
+	bool empty() const { return (0 == _size); }
+
+	T* data() { return std::launder(reinterpret_cast<T*>(_storage)); }
+
+	const T* data() const {
+		return std::launder(reinterpret_cast<const T*>(_storage));
+	}
+
+	iterator begin() { return data(); }
+	iterator end() { return data() + _size; }
+	const_iterator begin() const { return data(); }
+	const_iterator end() const { return data() + _size; }
+
+	T& operator[](size_type pos) { return data()[pos]; }
+	const T& operator[](size_type pos) const { return data()[pos]; }
+
+	/**
+	 * Bounds-checked element access.
+	 * Throws std::out_of_range on range error.
+	 */
+	T& at(size_type pos) {
+		guardRange(pos);
+		return data()[pos];
+	}
+
+	const T& at(size_type pos) const {
+		guardRange(pos);
+		return data()[pos];
+	}
+
+	void push_back(const T& value) {
+		guardCapacity(1);
+		::new (static_cast<void*>(data() + _size)) T{ value };
+		++_size;
+	}
+
+	template<typename... Args>
+	T& emplace_back(Args&&... args) {
+		guardCapacity(1);
+		T* res = ::new (static_cast<void*>(data() + _size))
+				T{ std::forward<Args>(args)... };
+		++_size;
+		return *res;
+	}
+
+	void clear() { _size = 0; }
+
+	bool operator==(const InlineVector& other) const {
+		if (_size != other._size)
+			return false;
+
+		for (size_type i = 0; i < _size; ++i)
+			if (!((*this)[i] == other[i]))
+				return false;
+
+		return true;
+	}
+
+private:
+	template<typename Iter, typename Sentinel>
+	void append(Iter first, Sentinel last, size_type count) {
+		guardCapacity(count);
+		for (; first != last; ++first)
+			push_back(*first);
+	}
+
+	void guardCapacity(size_type extraCount) const {
+		if (_size + extraCount > Capacity)
+			throw std::runtime_error{ "InlineVector capacity exceeded" };
+	}
+
+	void guardRange(size_type pos) const {
+		if (pos >= _size)
+			throw std::out_of_range{ "InlineVector index out of range" };
+	}
+
+	alignas(T) unsigned char _storage[Capacity * sizeof(T)];
+	std::uint8_t _size = 0;
+};
+
+}
+
+}
+
+#endif /* SRC_ALGEBRA_INLINEVECTOR_HPP_ */
@@ -17,15 +17,80 @@ namespace algebra {
 
 namespace LI {
 
-const std::string Basis::eta{ "\\eta" };
-const std::string Basis::epsilon{ "\\epsilon" };
-const std::string Basis::delta{ "\\delta" };
-
-const Basis::NameSet Basis::Elements {
-	Basis::eta,
-	Basis::delta,
-	Basis::epsilon
-};
+const Symbol Basis::eta{ "\\eta" };
+const Symbol Basis::epsilon{ "\\epsilon" };
+const Symbol Basis::delta{ "\\delta" };
+
+//----------------------------------------------------------------------
+
+namespace {
+
+bool packedLess(const TensorIndex& idx1, const TensorIndex& idx2) {
+	return idx1.raw() < idx2.raw();
+}
+
+}
+
+//----------------------------------------------------------------------
+
+void Monomial::assign(std::span<const Tensor> factors) {
+	pairs.clear();
+	epsilons.clear();
+	even = true;
+
+	for (const Tensor& factor : factors) {
+		if (!factor.complete())
+			throw std::runtime_error{ factor.id().str()
+										+ " has too few indices" };
+
+		//Any fixed index order yields a structural key,
+		//packed values are the cheapest to compare
+		Tensor canonical{ factor };
+		if (canonical.canonicalize(packedLess) < 0)
+			even = !even;
+
+		const Tensor::Indices& indices = canonical.indices();
+		if (factor.id() == Basis::epsilon)
+			epsilons.push_back(Quadruple{ indices[0].raw(), indices[1].raw(),
+									indices[2].raw(), indices[3].raw() });
+		else if ((factor.id() == Basis::eta)
+				|| (factor.id() == Basis::delta))
+			pairs.push_back(Pair{ indices[0].raw(), indices[1].raw(),
+									factor.id() == Basis::delta });
+		else
+			throw std::runtime_error{
+				"Invalid Lorentz-invariant tensor id" };
+	}
+
+	std::sort(pairs.begin(), pairs.end());
+	std::sort(epsilons.begin(), epsilons.end());
+}
+
+//----------------------------------------------------------------------
+
+size_t MonomialHash::operator()(const Monomial& m) const {
+	size_t value = m.pairs.size() | (m.epsilons.size() << 16);
+	auto combine = [&](std::uint64_t x) {
+		value ^= std::hash<std::uint64_t>{}(x) + 0x9e3779b9
+					+ (value << 6) + (value >> 2);
+	};
+
+	for (const Monomial::Pair& pair : m.pairs)
+		combine((static_cast<std::uint64_t>(pair.first) << 32
+					| pair.second) ^ (pair.isDelta ? 1 : 0));
+
+	for (const Monomial::Quadruple& q : m.epsilons)
+		for (std::uint32_t idx : q)
+			combine(idx);
+
+	return value;
+}
+
+//----------------------------------------------------------------------
+
+size_t MonomialTable::intern(const Monomial& m) {
+	return _ids.try_emplace(m, _ids.size()).first->second;
+}
 
 } /* namespace LI */
 
@@ -9,15 +9,27 @@
 #define SRC_ALGEBRA_LORENTZINVARIANT_HPP_
 
 #include <unordered_set>
+#include <unordered_map>
 #include <string>
 
 #include "TensorBase.hpp"
+#include "Symbol.hpp"
 #include <complex>
 #include "Polynomials.hpp"
 #include "Complex.hpp"
 #include "Rational.hpp"
 #include "Permutations.hpp"
+#include "Parallel.hpp"
 #include <algorithm>
+#include <span>
+#include <vector>
+#include <optional>
+#include <cstdint>
+#include <array>
+#include <utility>
+#include <compare>
+#include <iterator>
+#include <numeric>
 
 namespace dirac {
 
@@ -33,25 +45,27 @@ namespace LI {
 struct Basis {
 	Basis() = default;
 
-	static const std::string eta;
-	static const std::string epsilon;
-	static const std::string delta;
+	static const Symbol eta;
+	static const Symbol epsilon;
+	static const Symbol delta;
 
-	using NameSet = std::unordered_set<std::string>;
-	static const NameSet Elements;
+	/**
+	 * Maximum number of indices over all basis elements
+	 */
+	static constexpr size_t indexCapacity = 4;
 
 	/**
 	 * returns true if the argument identifies one of basis elements,
 	 * false otherwise
 	 */
-	inline static bool allows(const std::string& id) {
-		return (Elements.find(id) != Elements.end());
+	inline static bool allows(const Symbol& id) {
+		return (id == eta) || (id == delta) || (id == epsilon);
 	}
 
 	/**
 	 * Maximum number of indices a basis element can have
 	 */
-	inline static size_t maxIndexCount(const std::string& id) {
+	inline static size_t maxIndexCount(const Symbol& id) {
 		if (id == epsilon)
 			return 4;
 
@@ -62,12 +76,109 @@ struct Basis {
 		return 0;
 	}
 
+	/**
+	 * Index symmetry of a basis element
+	 */
+	inline static IndexSymmetry symmetry(const Symbol& id) {
+		if (id == epsilon)
+			return IndexSymmetry::Antisymmetric;
+
+		if ((id == delta) || (id == eta))
+			return IndexSymmetry::Symmetric;
+
+		return IndexSymmetry::None;
+	}
+
 };
 
 /**
  * Basis Lorentz-invariant (pseudo)-tensor ring element
  */
-using Tensor = TensorBase<std::string, Basis, IndexId>;
+using Tensor = TensorBase<Symbol, Basis, IndexId>;
+
+/**
+ * Matching form of a Lorentz-invariant monomial:
+ * sorted metric/Kronecker index pairs and sorted Levi-Civita
+ * index quadruples, with indices in packed form.
+ * Factor order and index order are forgotten,
+ * the sign of Levi-Civita index permutations is tracked.
+ * Two terms are mergeable if and only if their monomials are equal.
+ */
+struct Monomial {
+	/**
+	 * Metric or Kronecker symbol with indices in ascending order
+	 */
+	struct Pair {
+		std::uint32_t first;
+		std::uint32_t second;
+		bool isDelta;
+
+		auto operator<=>(const Pair& other) const = default;
+	};
+
+	/**
+	 * Levi-Civita symbol indices in ascending order
+	 */
+	using Quadruple = std::array<std::uint32_t, 4>;
+
+	std::vector<Pair> pairs;
+	std::vector<Quadruple> epsilons;
+
+	/**
+	 * Whether Levi-Civita indices were sorted by an even permutation
+	 */
+	bool even = true;
+
+	Monomial() = default;
+
+	explicit Monomial(std::span<const Tensor> factors) {
+		assign(factors);
+	}
+
+	/**
+	 * Rebuilds the monomial from term factors, reusing storage.
+	 * Throws std::runtime_error if a factor is not a complete
+	 * basis tensor.
+	 */
+	void assign(std::span<const Tensor> factors);
+
+	/**
+	 * Structural equality. The sign is not compared.
+	 */
+	bool operator==(const Monomial& other) const {
+		return (pairs == other.pairs) && (epsilons == other.epsilons);
+	}
+};
+
+/**
+ * Hash of a monomial
+ */
+struct MonomialHash {
+	size_t operator()(const Monomial& m) const;
+};
+
+/**
+ * Hash-consing table of monomials.
+ * Equal monomials are assigned equal dense identifiers 0, 1, ...
+ * in the order of first appearance, so that term structures
+ * are compared by comparing integers.
+ */
+class MonomialTable {
+public:
+	/**
+	 * Returns the identifier of the argument,
+	 * adding it to the table if necessary
+	 */
+	size_t intern(const Monomial& m);
+
+	/**
+	 * Number of distinct monomials
+	 */
+	size_t size() const { return _ids.size(); }
+
+private:
+	std::unordered_map<Monomial, size_t, MonomialHash> _ids;
+};
 
 /**
  * Lorentz-invariant (pseudo)-tensor polynomial type
@@ -77,63 +188,121 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	using Coeff = Complex<Scalar>;
 	using Base = Polynomial<Complex<Scalar>, Tensor>;
 	using Term = typename Base::Term;
+	using Terms = typename Base::Terms;
+	using TermRef = typename Base::TermRef;
+	using TermView = typename Base::TermView;
 
 	/**
 	 * Addition operator
 	 */
 	TensorPolynomial<Scalar>
-	operator+(const TensorPolynomial<Scalar>& other) const {
+	operator+(const TensorPolynomial<Scalar>& other) const& {
+		if (isSorted() && other.isSorted())
+			return mergeSorted(*this, other, false);
+
 		return sum<TensorPolynomial<Scalar>,
 					Coeff, Tensor>(*this, other);
 	}
 
+	TensorPolynomial<Scalar>
+	operator+(const TensorPolynomial<Scalar>& other) && {
+		if (isSorted() && other.isSorted())
+			return mergeSorted(*this, other, false);
+
+		return sum<TensorPolynomial<Scalar>,
+					Coeff, Tensor>(std::move(*this), other);
+	}
+
 	/**
 	 * Subtraction operator
 	 */
 	TensorPolynomial<Scalar>
-	operator-(const TensorPolynomial<Scalar>& other) const {
+	operator-(const TensorPolynomial<Scalar>& other) const& {
+		if (isSorted() && other.isSorted())
+			return mergeSorted(*this, other, true);
+
 		return diff<TensorPolynomial<Scalar>,
 					Coeff, Tensor>(*this, other);
 	}
 
+	TensorPolynomial<Scalar>
+	operator-(const TensorPolynomial<Scalar>& other) && {
+		if (isSorted() && other.isSorted())
+			return mergeSorted(*this, other, true);
+
+		return diff<TensorPolynomial<Scalar>,
+					Coeff, Tensor>(std::move(*this), other);
+	}
+
 	/**
-	 * Multiplication operator
+	 * Multiplication operator.
+	 * The product of polynomials in sorted form is sorted.
 	 */
 	TensorPolynomial<Scalar>
 	operator*(const TensorPolynomial<Scalar>& other) const {
-		return prod<TensorPolynomial<Scalar>,
-					Coeff, Tensor>(*this, other);
+		TensorPolynomial<Scalar> res = product(*this, other);
+		if (isSorted() && other.isSorted())
+			res.sortCanonicalTerms();
+
+		return res;
 	}
 
 	/**
 	 * Right multiplication by a complex coefficient
 	 */
-	TensorPolynomial<Scalar> operator*(const Coeff& c) const {
+	TensorPolynomial<Scalar> operator*(const Coeff& c) const& {
 		return prod<TensorPolynomial<Scalar>,
 					Coeff, Tensor>(*this, c);
 	}
 
+	TensorPolynomial<Scalar> operator*(const Coeff& c) && {
+		return prod<TensorPolynomial<Scalar>,
+					Coeff, Tensor>(std::move(*this), c);
+	}
+
 	/**
 	 * Negation (unary minus) operator
 	 */
-	TensorPolynomial<Scalar> operator-() const {
+	TensorPolynomial<Scalar> operator-() const& {
 		return negate<TensorPolynomial<Scalar>, Coeff, Tensor>(*this);
 	}
 
+	TensorPolynomial<Scalar> operator-() && {
+		return negate<TensorPolynomial<Scalar>,
+					Coeff, Tensor>(std::move(*this));
+	}
+
 	/**
 	 * Mutating addition
 	 */
 	TensorPolynomial<Scalar>& operator+=(
 			const TensorPolynomial<Scalar>& other) {
+		if (isSorted() && other.isSorted())
+			return *this = mergeSorted(*this, other, false);
+
 		return add<TensorPolynomial<Scalar>,
 					Coeff, Tensor>(*this, other);
 	}
 
+	/**
+	 * Mutating addition of a temporary
+	 */
+	TensorPolynomial<Scalar>& operator+=(TensorPolynomial<Scalar>&& other) {
+		if (isSorted() && other.isSorted())
+			return *this = mergeSorted(*this, other, false);
+
+		return add<TensorPolynomial<Scalar>,
+					Coeff, Tensor>(*this, std::move(other));
+	}
+
 	/**
 	 * Mutating subtraction
 	 */
 	TensorPolynomial<Scalar>& operator-=(
 			const TensorPolynomial<Scalar>& other) {
+		if (isSorted() && other.isSorted())
+			return *this = mergeSorted(*this, other, true);
+
 		return sub<TensorPolynomial<Scalar>,
 					Coeff, Tensor>(*this, other);
 	}
@@ -143,17 +312,22 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 */
 	TensorPolynomial<Scalar>& operator*=(
 			const TensorPolynomial<Scalar>& other) {
-		this->terms = (*this * other).terms;
-		return *this;
+		return *this = *this * other;
 	}
 
 	/**
 	 * Mutating right multiplication by a basis (pseudo)-tensor
 	 */
 	TensorPolynomial<Scalar>& operator*=(const Tensor& t) {
-		for (Term& term : this->terms)
-			term.factors.push_back(t);
-
+		Terms res;
+		res.reserve(this->terms.size(),
+				this->terms.factorCount() + this->terms.size());
+		for (const auto& term : std::as_const(this->terms))
+			res.append(term.coeff, term.factors,
+					std::span<const Tensor>{ &t, 1 });
+
+		this->terms = std::move(res);
+		_sorted = false;
 		return *this;
 	}
 
@@ -161,8 +335,8 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 * Mutating right multiplication by a complex number
 	 */
 	TensorPolynomial<Scalar>& operator*=(const Coeff& c) {
-		for (Term& term : this->terms)
-			term.coeff = term.coeff * c;
+		for (Coeff& coeff : this->terms.coeffs())
+			coeff = coeff * c;
 
 		return *this;
 	}
@@ -176,6 +350,8 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 */
 	TensorPolynomial&
 	operator=(const TensorPolynomial<Scalar>& other) = default;
+	TensorPolynomial&
+	operator=(TensorPolynomial<Scalar>&& other) = default;
 
 	/**
 	 * Promote a complex number to a zer-rank tensor polynomial
@@ -209,6 +385,84 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 */
 	void canonicalize() override;
 
+	/**
+	 * Polynomials with at least this many terms are canonicalized
+	 * by canonicalizeParallel
+	 */
+	static constexpr size_t parallelThreshold = 4096;
+
+	/**
+	 * Parallel canonicalization, see parallelFor.
+	 * Contiguous chunks of terms are expanded and contracted
+	 * concurrently, then terms are merged within shards of equal
+	 * structural key hashes, each shard in term order.
+	 * The result is the same as that of the sequential procedure.
+	 */
+	void canonicalizeParallel();
+
+	/**
+	 * Canonicalizes a term in place: Levi-Civita symbols are moved
+	 * to the end and indices are contracted.
+	 * The term must be at most linear in Levi-Civita symbol.
+	 * Returns the number of the term's leading factors holding the result
+	 * or an empty optional if the term is zero.
+	 */
+	static std::optional<size_t> canonicalizeTerm(const TermRef& term);
+
+	/**
+	 * Hash accumulator of canonical terms.
+	 * Added terms are canonicalized one at a time and merged
+	 * into the first added term with the same structural key,
+	 * so the result is the canonical form of the sum of added terms,
+	 * equal to that computed by canonicalize(), while the storage used
+	 * is bounded by the result size.
+	 */
+	class Accumulator {
+	public:
+		/**
+		 * Adds a term, canonicalizing it in place
+		 */
+		void add(const TermRef& term);
+
+		/**
+		 * Returns the accumulated polynomial,
+		 * leaving the accumulator empty
+		 */
+		TensorPolynomial<Scalar> finalize();
+
+	private:
+		/**
+		 * Merges a canonical term into the accumulated ones
+		 */
+		void merge(const TermView& term);
+
+		TensorPolynomial<Scalar> _value;
+
+		/**
+		 * Identifiers of structural keys are positions of accumulated terms
+		 */
+		MonomialTable _keys;
+		std::vector<bool> _parities;
+		Monomial _key;
+	};
+
+	/**
+	 * Fused polynomial multiplication: each pairwise product of terms
+	 * is canonicalized and merged into an Accumulator right away,
+	 * so raw products are never stored together.
+	 * The result is that of canonicalizing all raw products at once.
+	 */
+	static TensorPolynomial<Scalar> product(const TensorPolynomial<Scalar>& p1,
+											const TensorPolynomial<Scalar>& p2);
+
+	/**
+	 * Equality check: the polynomials are equal
+	 * if their difference canonicalizes to zero.
+	 * Polynomials in sorted form are compared by a single merging pass,
+	 * others are sorted first.
+	 */
+	bool operator==(const TensorPolynomial<Scalar>& other) const;
+
 	/**
 	 * Check if the polynomial is zero
 	 */
@@ -216,8 +470,8 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 		if (this->terms.empty())
 			return true;
 
-		for (const Term& term : this->terms)
-			if (term.coeff != zero<Scalar>())
+		for (const Coeff& coeff : this->terms.coeffs())
+			if (coeff != zero<Scalar>())
 				return false;
 
 		return true;
@@ -229,7 +483,39 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 * is zero or indices in a Levi-Civita symbol are contracted),
 	 * returns an empty optional.
 	 */
-	static std::optional<Term> contractIndices(const Term& src);
+	static std::optional<Term> contractIndices(const TermView& src);
+
+	/**
+	 * Contracts all contractible Lorentz indices in a term in place.
+	 * Contraction never adds factors, so the result occupies
+	 * the leading factors of the term; their number is returned.
+	 * If the resulting term is zero, returns an empty optional.
+	 */
+	static std::optional<size_t> contractIndices(const TermRef& term);
+
+	/**
+	 * Metric or Kronecker symbol in contraction-friendly form
+	 */
+	struct MetricFactor {
+		Symbol id;
+		TensorIndex i1;
+		TensorIndex i2;
+
+		const TensorIndex& slot(size_t i) const { return i ? i2 : i1; }
+	};
+
+	/**
+	 * Contracts metrics one at a time, each with the first following
+	 * factor sharing a dual index, and writes the remaining factors
+	 * over the term's leading ones. contractIndices falls back
+	 * to this method if an index label occurs more than twice,
+	 * since the result then depends on the contraction order.
+	 * Returns the number of factors written or an empty optional
+	 * if a Levi-Civita symbol vanishes.
+	 */
+	static std::optional<size_t> contractSequentially(const TermRef& term,
+			std::pmr::vector<MetricFactor>& metrics,
+			std::pmr::vector<Tensor>& epsilons);
 
 	/**
 	 * If two term have same tensorial structure up to a permutation of
@@ -241,7 +527,8 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 *
 	 * If the terms are not mergeable, returns an empty optional.
 	 */
-	static std::optional<Term> tryMerge(const Term& t1, const Term& t2);
+	static std::optional<Term> tryMerge(const TermView& t1,
+										const TermView& t2);
 
 	/**
 	 * Expands products of Levi-Civita symbols into sums of products
@@ -251,6 +538,15 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 	 */
 	void expandEpsilonPowers();
 
+	/**
+	 * Expands a product of two Levi-Civita symbols into products
+	 * of metric and/or Kronecker symbols. Dual index pairs shared
+	 * by the symbols are contracted in closed form,
+	 * so k shared pairs yield (4 - k)! terms instead of 24.
+	 */
+	static TensorPolynomial<Scalar> epsilonProduct(const Tensor& eps1,
+													const Tensor& eps2);
+
 	/**
 	 * Contracts all contractible Lorentz indices in each callee's term.
 	 */
@@ -258,15 +554,111 @@ struct TensorPolynomial : public Polynomial<Complex<Scalar>, Tensor> {
 
 	using Merger =
 			std::function<
-				std::optional<Term> (const Term& t1, const Term& t2)>;
+				std::optional<Term> (const TermView& t1,
+										const TermView& t2)>;
 
 	/**
 	 * Tries merging all mergeable terms using the user-provided
 	 * merger function. The function must return merging result
 	 * for two mergeable terms or an empty optional
-	 * if the terms are not mergeable
+	 * if the terms are not mergeable.
+	 * Every pair of terms is tried, so prefer mergeTerms()
+	 * when the default merger suffices.
+	 */
+	void mergeTerms(Merger merger);
+
+	/**
+	 * Transformation of a term, see mergeMapped
+	 */
+	using Mapping = std::function<void (const TermRef& term)>;
+
+	/**
+	 * Merges each term with all following terms whose images
+	 * under the mapping are mergeable with it by tryMerge.
+	 * The result is the same as that of mergeTerms(merger)
+	 * with the merger applying the mapping to a copy of its second
+	 * argument before calling tryMerge, but structural keys of terms
+	 * and their images are computed and hash-consed once,
+	 * so merging takes a single pass over the terms.
 	 */
-	void mergeTerms(Merger merger = tryMerge);
+	void mergeMapped(Mapping mapping);
+
+	/**
+	 * Merges all terms mergeable by tryMerge.
+	 * Terms are bucketed by their structural keys,
+	 * so merging takes a single pass over the terms.
+	 * The result is the same as that of mergeTerms(tryMerge).
+	 */
+	void mergeTerms();
+
+	/**
+	 * Structural key of a term, see Monomial.
+	 * Two terms are mergeable by tryMerge
+	 * if and only if their keys are equal.
+	 */
+	using TermKey = Monomial;
+
+	/**
+	 * Writes the structural key of the first argument to the second one.
+	 * Returns true if indices of Levi-Civita symbols are sorted
+	 * by an even permutation and false otherwise.
+	 */
+	static bool structuralKey(const TermView& term, TermKey& key);
+
+	/**
+	 * Brings the polynomial to sorted canonical form.
+	 * The polynomial is canonicalized, then the indices of each factor
+	 * are ordered as by Tensor::canonicalize, with the sign
+	 * moved to the coefficient, factors of each term are ordered
+	 * by factorOrder and terms are ordered by termOrder.
+	 * Mergeable terms then have equal factors, so polynomials
+	 * in sorted form are added, subtracted and compared
+	 * by linear merging, like sparse vectors.
+	 * The form is kept by these operations, by products
+	 * of sorted polynomials and by multiplication by numbers.
+	 */
+	void sortTerms();
+
+	/**
+	 * Brings a canonical polynomial to sorted form, see sortTerms
+	 */
+	void sortCanonicalTerms();
+
+	/**
+	 * Whether the polynomial is in sorted form.
+	 * Empty polynomials are sorted.
+	 */
+	bool isSorted() const { return _sorted || this->terms.empty(); }
+
+	/**
+	 * Total order of basis tensors with indices in canonical order:
+	 * metrics go first, then Kronecker symbols, then Levi-Civita
+	 * symbols; tensors of the same kind are ordered
+	 * lexicographically by indices, see IndexBase::operator<=>.
+	 * The order does not depend on the order of index label interning.
+	 */
+	static std::strong_ordering factorOrder(const Tensor& t1,
+											const Tensor& t2);
+
+	/**
+	 * Total order of sorted term factors:
+	 * lexicographic by factorOrder
+	 */
+	static std::strong_ordering termOrder(std::span<const Tensor> f1,
+											std::span<const Tensor> f2);
+
+	/**
+	 * Sum of polynomials in sorted form, or their difference
+	 * if the third argument is true, computed by merging their terms.
+	 * Terms cancelling each other are dropped. The result is sorted.
+	 */
+	static TensorPolynomial<Scalar> mergeSorted(
+			const TensorPolynomial<Scalar>& p1,
+			const TensorPolynomial<Scalar>& p2,
+			bool subtract);
+
+private:
+	bool _sorted = false;
 };
 
 } /* namespace LI */
@@ -283,7 +675,7 @@ namespace std {
 template<>
 struct hash<dirac::algebra::LI::Tensor> {
 	size_t operator()(const dirac::algebra::LI::Tensor& t) const {
-		size_t value = std::hash<std::string>{}(t.id());
+		size_t value = std::hash<dirac::algebra::Symbol>{}(t.id());
 		for (const auto& idx: t.indices())
 			value = value
 					^ std::hash<dirac::algebra::TensorIndex>{}(idx);
@@ -309,7 +701,7 @@ namespace LI {
 template<typename Scalar>
 TensorPolynomial<Scalar>
 eta(const TensorIndex& mu, const TensorIndex& nu)  {
-	std::string id = (mu.isUpper == nu.isUpper) ?
+	const Symbol& id = (mu.isUpper() == nu.isUpper()) ?
 							Basis::eta : Basis::delta;
 	return Tensor::create(id, Tensor::Indices{ mu, nu });
 }
@@ -353,6 +745,19 @@ operator*(const Complex<Scalar>& c, const TensorPolynomial<Scalar>& p) {
 
 //----------------------------------------------------------------------
 
+/**
+ * Left multiplication of a temporary (pseudo)-tensor polynomial
+ * by a complex number, performed in place
+ */
+template<typename Scalar>
+inline TensorPolynomial<Scalar>
+operator*(const Complex<Scalar>& c, TensorPolynomial<Scalar>&& p) {
+	return prod<TensorPolynomial<Scalar>,
+				Complex<Scalar>, Tensor>(c, std::move(p));
+}
+
+//----------------------------------------------------------------------
+
 /**
  * Mutating left multiplication of a (pseudo)-tensor polynomial
  * by a basis (pseudo)-tensor
@@ -360,8 +765,13 @@ operator*(const Complex<Scalar>& c, const TensorPolynomial<Scalar>& p) {
 template<typename Scalar>
 inline TensorPolynomial<Scalar>&
 operator*=(const Tensor& t, TensorPolynomial<Scalar>& p) {
-	for (typename TensorPolynomial<Scalar>::Term& term : p.terms)
-		term.factors.insert(term.factors.begin(), t);
+	typename TensorPolynomial<Scalar>::Terms res;
+	res.reserve(p.terms.size(), p.terms.factorCount() + p.terms.size());
+	for (const auto& term : std::as_const(p.terms))
+		res.append(term.coeff, std::span<const Tensor>{ &t, 1 },
+				term.factors);
+
+	p.terms = std::move(res);
 	return p;
 }
 
@@ -374,8 +784,8 @@ operator*=(const Tensor& t, TensorPolynomial<Scalar>& p) {
 template<typename Scalar>
 inline TensorPolynomial<Scalar>&
 operator*=(const Complex<Scalar>& c, TensorPolynomial<Scalar>& p) {
-	for (typename TensorPolynomial<Scalar>::Term& term : p.terms)
-		term.coeff = c * term.coeff;
+	for (Complex<Scalar>& coeff : p.terms.coeffs())
+		coeff = c * coeff;
 	return p;
 }
 
@@ -388,7 +798,7 @@ operator*=(const Complex<Scalar>& c, TensorPolynomial<Scalar>& p) {
 template<typename Scalar>
 inline TensorPolynomial<Scalar> operator-(const Tensor& t) {
 	TensorPolynomial<Scalar> res{t};
-	res.terms[0].coeff = -one<Scalar>();
+	res.terms.coeffs()[0] = -one<Scalar>();
 	return res;
 }
 
@@ -396,17 +806,262 @@ inline TensorPolynomial<Scalar> operator-(const Tensor& t) {
 
 template<typename Scalar>
 void TensorPolynomial<Scalar>::canonicalize() {
-	//Filter out zeros
-	typename TensorPolynomial<Scalar>::Terms tmpTerms;
-	for (typename TensorPolynomial<Scalar>::Term& term : this->terms)
-		if (term.coeff != zero<Scalar>())
-			tmpTerms.push_back(term);
+	if ((this->terms.size() >= parallelThreshold) && (threadCount() > 1)) {
+		canonicalizeParallel();
+		return;
+	}
+
+	//Only products of Levi-Civita symbols change the number of terms,
+	//so the polynomial is rebuilt only if there are some
+	bool hasEpsilonPowers = false;
+	for (const auto& term : std::as_const(this->terms)) {
+		if (term.coeff == zero<Scalar>())
+			continue;
 
-	this->terms = tmpTerms;
+		size_t count = 0;
+		for (const Tensor& factor : term.factors)
+			if (factor.id() == Basis::epsilon)
+				++count;
+
+		if (count > 1) {
+			hasEpsilonPowers = true;
+			break;
+		}
+	}
+
+	if (hasEpsilonPowers)
+		expandEpsilonPowers();
+
+	//Filter out zeros, then contract each term in place
+	this->terms.rewrite([](const TermRef& term) {
+		return canonicalizeTerm(term);
+	});
 
-	expandEpsilonPowers();
-	contractIndices();
 	mergeTerms();
+	_sorted = false;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::canonicalizeParallel() {
+	const Terms& source = this->terms;
+	size_t termCount = source.size();
+	size_t chunkCount = std::min(threadCount() * 4, termCount);
+
+	//Canonical terms of a chunk with their structural keys.
+	//Term storage is created by the worker, see parallelFor.
+	struct Chunk {
+		std::optional<Terms> terms;
+		std::vector<Monomial> keys;
+		std::vector<bool> evens;
+		std::vector<size_t> hashes;
+	};
+
+	std::vector<Chunk> chunks(chunkCount);
+	parallelFor(chunkCount, [&](size_t c) {
+		Chunk& chunk = chunks[c];
+		Terms& res = chunk.terms.emplace();
+		auto add = [&](const TermRef& term) {
+			std::optional<size_t> count = canonicalizeTerm(term);
+			if (!count)
+				return;
+
+			TermView canonical{ term.coeff,
+								term.factors.first(count.value()) };
+			res.push_back(canonical);
+			Monomial& key = chunk.keys.emplace_back();
+			chunk.evens.push_back(structuralKey(canonical, key));
+			chunk.hashes.push_back(MonomialHash{}(key));
+		};
+
+		Term raw;
+		size_t end = termCount * (c + 1) / chunkCount;
+		for (size_t i = termCount * c / chunkCount; i < end; ++i) {
+			TermView term = source[i];
+			if (term.coeff == zero<Scalar>())
+				continue;
+
+			size_t epsilonCount = 0;
+			for (const Tensor& factor : term.factors)
+				if (factor.id() == Basis::epsilon)
+					++epsilonCount;
+
+			if (epsilonCount < 2) {
+				raw.coeff = term.coeff;
+				raw.factors.assign(term.factors.begin(), term.factors.end());
+				add(TermRef{ raw.coeff, raw.factors });
+				continue;
+			}
+
+			TensorPolynomial<Scalar> expanded;
+			expanded.terms.push_back(term);
+			expanded.expandEpsilonPowers();
+			for (const TermRef& expandedTerm : expanded.terms)
+				add(expandedTerm);
+		}
+	});
+
+	Terms canonical;
+	std::vector<Monomial> keys;
+	std::vector<bool> evens;
+	std::vector<size_t> hashes;
+	for (Chunk& chunk : chunks) {
+		canonical.append(*chunk.terms);
+		std::move(chunk.keys.begin(), chunk.keys.end(),
+				std::back_inserter(keys));
+		evens.insert(evens.end(), chunk.evens.begin(), chunk.evens.end());
+		hashes.insert(hashes.end(),
+				chunk.hashes.begin(), chunk.hashes.end());
+	}
+
+	chunks.clear();
+
+	//Each term is merged into the first one with the same key.
+	//Equal keys fall into the same shard, which is scanned in order,
+	//so merging goes as in mergeTerms().
+	size_t count = canonical.size();
+	size_t shardCount = chunkCount;
+	std::span<Coeff> coeffs = canonical.coeffs();
+	std::vector<char> kept(count, 1);
+	parallelFor(shardCount, [&](size_t shard) {
+		MonomialTable shardKeys;
+		std::vector<size_t> firsts;
+		for (size_t i = 0; i < count; ++i) {
+			if (hashes[i] % shardCount != shard)
+				continue;
+
+			size_t id = shardKeys.intern(keys[i]);
+			if (id == firsts.size()) {
+				firsts.push_back(i);
+				continue;
+			}
+
+			size_t first = firsts[id];
+			if (evens[first] == evens[i])
+				coeffs[first] += coeffs[i];
+			else
+				coeffs[first] -= coeffs[i];
+
+			kept[i] = 0;
+		}
+	});
+
+	size_t pos = 0;
+	canonical.rewrite([&](const TermRef& term) {
+		return kept[pos++] ? std::optional<size_t>{ term.factors.size() }
+						: std::optional<size_t>{};
+	});
+
+	this->terms = std::move(canonical);
+	_sorted = false;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+std::optional<size_t>
+TensorPolynomial<Scalar>::canonicalizeTerm(const TermRef& term) {
+	if (term.coeff == zero<Scalar>())
+		return std::optional<size_t>{};
+
+	//Levi-Civita symbols go last, as after expandEpsilonPowers
+	size_t pos = 0;
+	for (size_t i = 0; i < term.factors.size(); ++i)
+		if (term.factors[i].id() != Basis::epsilon) {
+			if (i != pos)
+				std::rotate(term.factors.begin() + pos,
+						term.factors.begin() + i,
+						term.factors.begin() + i + 1);
+
+			++pos;
+		}
+
+	return contractIndices(term);
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::Accumulator::add(const TermRef& term) {
+	if (term.coeff == zero<Scalar>())
+		return;
+
+	size_t epsilonCount = 0;
+	for (const Tensor& factor : term.factors)
+		if (factor.id() == Basis::epsilon)
+			++epsilonCount;
+
+	if (epsilonCount < 2) {
+		std::optional<size_t> count = canonicalizeTerm(term);
+		if (count)
+			merge(TermView{ term.coeff, term.factors.first(count.value()) });
+
+		return;
+	}
+
+	TensorPolynomial<Scalar> expanded;
+	expanded.terms.push_back(term);
+	expanded.expandEpsilonPowers();
+	for (const TermRef& expandedTerm : expanded.terms) {
+		std::optional<size_t> count = canonicalizeTerm(expandedTerm);
+		if (count)
+			merge(TermView{ expandedTerm.coeff,
+						expandedTerm.factors.first(count.value()) });
+	}
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::Accumulator::merge(const TermView& term) {
+	bool even = structuralKey(term, _key);
+	size_t id = _keys.intern(_key);
+	if (id == _parities.size()) {
+		_parities.push_back(even);
+		_value.terms.push_back(term);
+		return;
+	}
+
+	Coeff& merged = _value.terms.coeffs()[id];
+	if (_parities[id] == even)
+		merged += term.coeff;
+	else
+		merged -= term.coeff;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+TensorPolynomial<Scalar> TensorPolynomial<Scalar>::Accumulator::finalize() {
+	TensorPolynomial<Scalar> res{ std::move(_value) };
+	_value = TensorPolynomial<Scalar>{};
+	_keys = MonomialTable{};
+	_parities.clear();
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+TensorPolynomial<Scalar>
+TensorPolynomial<Scalar>::product(const TensorPolynomial<Scalar>& p1,
+									const TensorPolynomial<Scalar>& p2) {
+	Accumulator acc;
+	Term raw;
+	for (const TermView& t1 : p1.terms)
+		for (const TermView& t2 : p2.terms) {
+			raw.coeff = t1.coeff * t2.coeff;
+			if (raw.coeff == zero<Scalar>())
+				continue;
+
+			raw.factors.assign(t1.factors.begin(), t1.factors.end());
+			raw.factors.insert(raw.factors.end(),
+					t2.factors.begin(), t2.factors.end());
+			acc.add(TermRef{ raw.coeff, raw.factors });
+		}
+
+	return acc.finalize();
 }
 
 //----------------------------------------------------------------------
@@ -414,12 +1069,13 @@ void TensorPolynomial<Scalar>::canonicalize() {
 template<typename Scalar>
 void TensorPolynomial<Scalar>::expandEpsilonPowers() {
 	typename TensorPolynomial<Scalar>::Terms tmpTerms;
-	for (typename TensorPolynomial<Scalar>::Term& term : this->terms) {
+	tmpTerms.reserve(this->terms.size(), this->terms.factorCount());
+	for (const auto& term : std::as_const(this->terms)) {
 		TensorPolynomial<Scalar> tmp{ term.coeff };
 		std::optional<Tensor> epsCache;
 
-		for (Tensor& factor : term.factors) {
-			const std::string& aId = factor.id();
+		for (const Tensor& factor : term.factors) {
+			const Symbol& aId = factor.id();
 			if ((aId == Basis::delta) || (aId == Basis::eta)) {
 				tmp *= factor;
 			} else if (aId == Basis::epsilon) {
@@ -432,28 +1088,7 @@ void TensorPolynomial<Scalar>::expandEpsilonPowers() {
 								"Levi-Civita symbol "
 								"must have four indices" };
 
-					TensorPolynomial<Scalar> expansion;
-					forPermutations(4, [&](const Permutation& perm) {
-						TensorPolynomial<Scalar>
-						expTerm{ one<Scalar>() };
-
-						const TensorIndices&
-						factorIndices = factor.indices();
-
-						const TensorIndices&
-						cachedIndices = cached.indices();
-
-						for (unsigned int i = 0; i < 4; ++i)
-							expTerm *= eta<Scalar>(cachedIndices[i],
-											factorIndices[perm.map[i]]);
-
-						if (perm.isEven)
-							expansion -= expTerm;
-						else
-							expansion += expTerm;
-					});
-
-					tmp *= expansion;
+					tmp *= epsilonProduct(cached, factor);
 					epsCache.reset();
 				}
 			}
@@ -462,27 +1097,100 @@ void TensorPolynomial<Scalar>::expandEpsilonPowers() {
 		if (epsCache)
 			tmp *= epsCache.value();
 
-		tmpTerms.insert(tmpTerms.end(),
-				tmp.terms.begin(), tmp.terms.end());
+		tmpTerms.append(tmp.terms);
 	}
 
-	this->terms = tmpTerms;
+	this->terms = std::move(tmpTerms);
 }
 
 //----------------------------------------------------------------------
 
 template<typename Scalar>
-void TensorPolynomial<Scalar>::contractIndices() {
-	typename TensorPolynomial<Scalar>::Terms tmpTerms;
-	tmpTerms.reserve(this->terms.size());
+TensorPolynomial<Scalar>
+TensorPolynomial<Scalar>::epsilonProduct(const Tensor& eps1,
+											const Tensor& eps2) {
+	TensorPolynomial<Scalar> res;
+
+	//A Levi-Civita symbol with repeated indices vanishes
+	Tensor canonical1{ eps1 };
+	Tensor canonical2{ eps2 };
+	if ((canonical1.canonicalize() == 0) || (canonical2.canonicalize() == 0))
+		return res;
+
+	const Tensor::Indices& indices1 = eps1.indices();
+	const Tensor::Indices& indices2 = eps2.indices();
+
+	//Index orders with shared dual pairs moved to the front
+	std::array<unsigned int, 4> order1;
+	std::array<unsigned int, 4> order2;
+	std::array<bool, 4> used1{};
+	std::array<bool, 4> used2{};
+	unsigned int shared = 0;
+	for (unsigned int i = 0; i < 4; ++i)
+		for (unsigned int j = 0; j < 4; ++j)
+			if (!used2[j] && indices1[i].dual(indices2[j])) {
+				order1[shared] = i;
+				order2[shared] = j;
+				used1[i] = true;
+				used2[j] = true;
+				++shared;
+				break;
+			}
+
+	unsigned int pos1 = shared;
+	unsigned int pos2 = shared;
+	for (unsigned int i = 0; i < 4; ++i) {
+		if (!used1[i])
+			order1[pos1++] = i;
 
-	for (typename TensorPolynomial<Scalar>::Term& term : this->terms) {
-		std::optional<Term> tmp = contractIndices(term);
-		if (tmp)
-			tmpTerms.push_back(tmp.value());
+		if (!used2[i])
+			order2[pos2++] = i;
 	}
 
-	this->terms = tmpTerms;
+	bool even = true;
+	for (unsigned int i = 0; i < 4; ++i)
+		for (unsigned int j = i + 1; j < 4; ++j) {
+			if (order1[i] > order1[j])
+				even = !even;
+
+			if (order2[i] > order2[j])
+				even = !even;
+		}
+
+	//Contracting k index pairs leaves k! copies of each term
+	int multiplicity = 1;
+	for (unsigned int i = 2; i <= shared; ++i)
+		multiplicity *= i;
+
+	Coeff coeff = one<Scalar>() * static_cast<Scalar>(multiplicity);
+	if (even)
+		coeff = -coeff;
+
+	unsigned int rest = 4 - shared;
+	std::array<Tensor, 4> factors{ eps1, eps1, eps1, eps1 };
+	forPermutations(rest, [&](const Permutation& perm) {
+		for (unsigned int i = 0; i < rest; ++i) {
+			const TensorIndex& mu = indices1[order1[shared + i]];
+			const TensorIndex& nu = indices2[order2[shared + perm.map[i]]];
+			const Symbol& id = (mu.isUpper() == nu.isUpper()) ?
+									Basis::eta : Basis::delta;
+			factors[i] = Tensor::create(id, Tensor::Indices{ mu, nu });
+		}
+
+		res.terms.append(perm.isEven ? coeff : -coeff,
+				std::span<const Tensor>{ factors.data(), rest });
+	});
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::contractIndices() {
+	this->terms.rewrite([](const TermRef& term) {
+		return contractIndices(term);
+	});
 }
 
 //----------------------------------------------------------------------
@@ -490,87 +1198,246 @@ void TensorPolynomial<Scalar>::contractIndices() {
 template<typename Scalar>
 std::optional<typename TensorPolynomial<Scalar>::Term>
 TensorPolynomial<Scalar>::contractIndices(
-		const typename TensorPolynomial<Scalar>::Term& src) {
-	if (src.coeff == zero<Scalar>())
+		const typename TensorPolynomial<Scalar>::TermView& src) {
+	Term res{ src };
+	std::optional<size_t> count =
+			contractIndices(TermRef{ res.coeff, res.factors });
+	if (!count)
 		return std::optional<Term>{};
 
-	if (src.factors.empty())
-		return src;
+	res.factors.erase(res.factors.begin() + count.value(),
+			res.factors.end());
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+std::optional<size_t>
+TensorPolynomial<Scalar>::contractIndices(
+		const typename TensorPolynomial<Scalar>::TermRef& term) {
+	if (term.coeff == zero<Scalar>())
+		return std::optional<size_t>{};
 
-	Term res{ src.coeff };
+	if (term.factors.empty())
+		return term.factors.size();
 
-	std::vector<Tensor> metrics;
-	metrics.reserve(src.factors.size());
+	std::pmr::vector<MetricFactor> metrics;
+	metrics.reserve(term.factors.size());
 
-	std::vector<Tensor> epsilons;
-	epsilons.reserve(src.factors.size());
+	std::pmr::vector<Tensor> epsilons;
 
-	for (const Tensor& factor : src.factors) {
+	for (const Tensor& factor : term.factors) {
 		if (factor.id() ==  Basis::epsilon) {
 			if (!factor.complete())
-				throw std::runtime_error{factor.id()
+				throw std::runtime_error{factor.id().str()
 											+ " requires four indices"};
 
 			epsilons.push_back(factor);
 		} else if ((factor.id() == Basis::eta)
 				|| (factor.id() == Basis::delta)) {
 			if (!factor.complete())
-				throw std::runtime_error{factor.id()
+				throw std::runtime_error{factor.id().str()
 											+ " requires two indices"};
-			metrics.push_back(factor);
+			metrics.push_back(MetricFactor{ factor.id(),
+						factor.indices()[0], factor.indices()[1] });
 		} else
 			throw std::runtime_error{
 				"Invalid Lorentz-invariant tensor id" };
 	}
 
-	while (!metrics.empty()) {
-		Tensor first = metrics[0];
-		metrics.erase(metrics.begin());
+	//Index slots are numbered metrics first, two per metric,
+	//then epsilons, four per symbol
+	size_t metricSlots = 2 * metrics.size();
+	size_t slotCount = metricSlots + 4 * epsilons.size();
+	auto slotIndex = [&](size_t slot) -> const TensorIndex& {
+		if (slot < metricSlots)
+			return metrics[slot / 2].slot(slot % 2);
+
+		slot -= metricSlots;
+		return epsilons[slot / 4].indices()[slot % 4];
+	};
+
+	//Occurrence map: slots sorted by index label,
+	//so that dual indices become adjacent
+	std::pmr::vector<std::uint64_t> occurrences;
+	occurrences.reserve(slotCount);
+	for (size_t slot = 0; slot < slotCount; ++slot)
+		occurrences.push_back(
+				(static_cast<std::uint64_t>(slotIndex(slot).id().raw()) << 32)
+				| slot);
+
+	std::sort(occurrences.begin(), occurrences.end());
+
+	//Slot holding the index dual to the given one, or slotCount
+	std::pmr::vector<size_t> partner(slotCount, slotCount);
+	bool contracted = false;
+	for (size_t i = 0; i < occurrences.size(); ) {
+		size_t next = i + 1;
+		while ((next < occurrences.size())
+				&& ((occurrences[next] >> 32) == (occurrences[i] >> 32)))
+			++next;
+
+		if (next - i > 2)
+			return contractSequentially(term, metrics, epsilons);
+
+		size_t slot1 = occurrences[i] & 0xffffffffu;
+		size_t slot2 = occurrences[next - 1] & 0xffffffffu;
+		if ((next - i == 2) && slotIndex(slot1).dual(slotIndex(slot2))) {
+			partner[slot1] = slot2;
+			partner[slot2] = slot1;
+			contracted = true;
+		}
+
+		i = next;
+	}
+
+	auto vanishes = [](const Tensor& eps) {
+		const Tensor::Indices& indices = eps.indices();
+		for (size_t i = 0; i < indices.size(); ++i)
+			for (size_t j = i + 1; j < indices.size(); ++j)
+				if (indices[i].dual(indices[j])
+						|| (indices[i] == indices[j]))
+					return true;
+
+		return false;
+	};
+
+	if (!contracted) {
+		for (const Tensor& eps : epsilons)
+			if (vanishes(eps))
+				return std::optional<size_t>{};
+
+		return term.factors.size();
+	}
+
+	//Metrics linked by dual indices form chains, which are walked
+	//once each. A closed chain is a trace. An open chain collapses
+	//into its last metric or into the Levi-Civita symbol it ends at.
+	std::pmr::vector<bool> visited(metrics.size(), false);
+	std::pmr::vector<bool> survives(metrics.size(), false);
+	for (size_t first = 0; first < metrics.size(); ++first) {
+		if (visited[first])
+			continue;
+
+		visited[first] = true;
+
+		size_t last = first;
+		size_t lastSlot = 2 * first;
 
-		const TensorIndex& i1 = first.indices()[0];
-		const TensorIndex& i2 = first.indices()[1];
+		//Follows the chain from a slot to its outermost metric slot,
+		//which is stored back to the argument.
+		//Returns false if the chain closes.
+		auto walk = [&](size_t& slot, bool towardsFirst) {
+			while (true) {
+				size_t next = partner[slot];
+				if (next >= metricSlots)
+					return true;
+
+				size_t metric = next / 2;
+				if (metric == first)
+					return false;
+
+				visited[metric] = true;
+				if (metric > last) {
+					last = metric;
+					lastSlot = towardsFirst ? next : (next ^ 1);
+				}
+
+				slot = next ^ 1;
+			}
+		};
+
+		//lastSlot tracks the slot of the last metric facing end1
+		size_t end1 = 2 * first;
+		if (!walk(end1, false)) {
+			term.coeff *= Complex<Scalar>{ 4, 0 };
+			continue;
+		}
+
+		size_t end2 = 2 * first + 1;
+		walk(end2, true);
+
+		size_t outer1 = partner[end1];
+		size_t outer2 = partner[end2];
+		if ((outer1 < slotCount) || (outer2 < slotCount)) {
+			size_t target = std::min(outer1, outer2) - metricSlots;
+			const TensorIndex& repl =
+					slotIndex((outer1 < outer2) ? end2 : end1);
+			epsilons[target / 4].replaceIndex(target % 4, repl);
+			continue;
+		}
+
+		const TensorIndex& idx1 = slotIndex(end1);
+		const TensorIndex& idx2 = slotIndex(end2);
+		bool firstFacesEnd1 = ((lastSlot % 2) == 0);
+		MetricFactor merged{ (idx1.isUpper() != idx2.isUpper())
+								? Basis::delta : Basis::eta,
+						firstFacesEnd1 ? idx1 : idx2,
+						firstFacesEnd1 ? idx2 : idx1 };
+		metrics[last] = merged;
+		survives[last] = true;
+	}
+
+	size_t count = 0;
+	for (size_t i = 0; i < metrics.size(); ++i)
+		if (survives[i])
+			term.factors[count++] = Tensor::create(metrics[i].id,
+						Tensor::Indices{ metrics[i].i1, metrics[i].i2 });
+
+	for (const Tensor& eps : epsilons) {
+		//Check for same indices in Livi-Civita symbol
+		if (vanishes(eps))
+			return std::optional<size_t>{};
+
+		term.factors[count++] = eps;
+	}
+
+	return count;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+std::optional<size_t>
+TensorPolynomial<Scalar>::contractSequentially(const TermRef& term,
+		std::pmr::vector<MetricFactor>& metrics,
+		std::pmr::vector<Tensor>& epsilons) {
+	size_t count = 0;
+
+	//Each metric is contracted with the first following factor
+	//sharing a dual index, or moved to the result
+	for (size_t iFirst = 0; iFirst < metrics.size(); ++iFirst) {
+		const MetricFactor first = metrics[iFirst];
+		const TensorIndex& i1 = first.i1;
+		const TensorIndex& i2 = first.i2;
 
 		//Check for trace
 		if (i1.dual(i2)) {
-			res.coeff *= Complex<Scalar>{ 4, 0 };
+			term.coeff *= Complex<Scalar>{ 4, 0 };
 			continue;
 		}
 
 		bool merged = false;
 
 		//Try contracting with other metric tensors
-		for (Tensor& m : metrics) {
-			if (merged)
-				continue;
-
-			TensorIndices tmpIndices;
-			tmpIndices.reserve(m.indices().size());
-			for (const TensorIndex& idx: m.indices()) {
-				if (idx.dual(i1) && !merged) {
-					tmpIndices.push_back(i2);
-					merged = true;
-				} else if (idx.dual(i2) && !merged) {
-					tmpIndices.push_back(i1);
-					merged = true;
-				} else {
-					tmpIndices.push_back(idx);
-				}
-			}
-
-			if (!merged)
+		for (size_t iM = iFirst + 1; (iM < metrics.size()) && !merged;
+				++iM) {
+			MetricFactor& m = metrics[iM];
+			if (m.i1.dual(i1))
+				m.i1 = i2;
+			else if (m.i1.dual(i2))
+				m.i1 = i1;
+			else if (m.i2.dual(i1))
+				m.i2 = i2;
+			else if (m.i2.dual(i2))
+				m.i2 = i1;
+			else
 				continue;
 
-			bool hasUpper = false;
-			bool hasLower = false;
-			for (TensorIndex& idx: tmpIndices)
-				if (idx.isUpper)
-					hasUpper = true;
-				else
-					hasLower = true;
-
-			std::string tensorId = (hasUpper && hasLower)
-										? Basis::delta : Basis::eta;
-			m = Tensor::create(tensorId, tmpIndices);
+			merged = true;
+			m.id = (m.i1.isUpper() != m.i2.isUpper())
+					? Basis::delta : Basis::eta;
 		}
 
 		//Now try contracting with epsilons
@@ -578,7 +1445,7 @@ TensorPolynomial<Scalar>::contractIndices(
 			if (merged)
 				continue;
 
-			const TensorIndices& indices = eps.indices();
+			const Tensor::Indices& indices = eps.indices();
 			for (size_t i = 0; i < indices.size(); ++i) {
 				if (indices[i].dual(i1) && !merged) {
 					eps.replaceIndex(i, i2);
@@ -591,111 +1458,381 @@ TensorPolynomial<Scalar>::contractIndices(
 		}
 
 		if (!merged)
-			res.factors.push_back(first);
+			term.factors[count++] = Tensor::create(first.id,
+							Tensor::Indices{ first.i1, first.i2 });
 	}
 
 	for (Tensor& eps : epsilons) {
-		const TensorIndices& indices = eps.indices();
+		const Tensor::Indices& indices = eps.indices();
 
 		//Check for same indices in Livi-Civita symbol
 		for (size_t i = 0; i < indices.size(); ++i)
 			for (size_t j = i + 1; j < indices.size(); ++j)
 				if (indices[i].dual(indices[j])
 						|| (indices[i] == indices[j]))
-					return std::optional<Term>{};
+					return std::optional<size_t>{};
 
-		res.factors.push_back(eps);
+		term.factors[count++] = eps;
 	}
 
-	return res;
+	return count;
 }
 
 //----------------------------------------------------------------------
 
 template<typename Scalar>
 std::optional<typename TensorPolynomial<Scalar>::Term>
-TensorPolynomial<Scalar>::tryMerge(const Term &t1, const Term &t2) {
+TensorPolynomial<Scalar>::tryMerge(const TermView& t1,
+									const TermView& t2) {
 	if (t1.factors.size() != t2.factors.size())
 		return std::optional<Term>{};
 
-	bool even = true;
-	std::unordered_set<size_t> iMap1;
-	iMap1.reserve(t1.factors.size());
-	for (size_t i = 0; i < t1.factors.size(); ++i)
-		iMap1.insert(i);
-
-	std::unordered_set<size_t> iMap2;
-	iMap2.reserve(t2.factors.size());
-	for (size_t i = 0; i < t2.factors.size(); ++i)
-		iMap2.insert(i);
-
-	while (!iMap1.empty()) {
-		size_t iFirst = *iMap1.begin();
-		iMap1.erase(iFirst);
-
-		std::optional<size_t> iMatch;
-		for (size_t iSecond : iMap2) {
-			if (iMatch)
+	Monomial m1{ t1.factors };
+	Monomial m2{ t2.factors };
+	if (!(m1 == m2))
+		return std::optional<Term>{};
+
+	Term res{ t1 };
+	if (m1.even == m2.even)
+		res.coeff += t2.coeff;
+	else
+		res.coeff -= t2.coeff;
+
+	return res;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::mergeTerms(Merger merger) {
+	//Each term is merged with all mergeable terms following it.
+	//Merged terms are written over the first ones in place.
+	size_t termCount = this->terms.size();
+	std::vector<bool> merged(termCount, false);
+	size_t i = 0;
+	this->terms.rewrite([&](const TermRef& first) {
+		size_t pos = i++;
+		if (merged[pos])
+			return std::optional<size_t>{};
+
+		size_t count = first.factors.size();
+		for (size_t j = pos + 1; j < termCount; ++j) {
+			if (merged[j])
 				continue;
 
-			const Tensor& first = t1.factors[iFirst];
-			const Tensor& second = t2.factors[iSecond];
+			std::optional<Term> res = merger(
+					TermView{ first.coeff, first.factors.first(count) },
+					this->terms[j]);
+			if (!res)
+				continue;
 
-			std::optional<Permutation>
-			mapping = first.mappingTo(second);
-			if (mapping) {
-				iMatch = iSecond;
+			if (res->factors.size() > count)
+				throw std::runtime_error{
+					"Merged term has more factors than the original" };
 
-				if (first.id() == Basis::epsilon) {
-					even = (even && mapping.value().isEven)
-							|| (!even && !mapping.value().isEven);
-				}
-			}
+			first.coeff = res->coeff;
+			count = res->factors.size();
+			std::copy(res->factors.begin(), res->factors.end(),
+					first.factors.begin());
+			merged[j] = true;
 		}
 
-		//If a non-matching factor is found, return empty optional
-		if (iMatch)
-			iMap2.erase(iMatch.value());
+		return std::optional<size_t>{ count };
+	});
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::mergeTerms() {
+	//Identifiers of structural keys are positions of merged terms
+	MonomialTable keys;
+
+	//Index permutation parity of each merged term
+	std::vector<bool> parities;
+	parities.reserve(this->terms.size());
+
+	//Terms are merged into the first ones with the same key,
+	//which are kept in place
+	TermKey key;
+	this->terms.rewrite([&](const TermRef& term) {
+		bool even = structuralKey(term, key);
+		size_t id = keys.intern(key);
+		if (id == parities.size()) {
+			parities.push_back(even);
+			return std::optional<size_t>{ term.factors.size() };
+		}
+
+		Coeff& merged = this->terms.coeffs()[id];
+		if (parities[id] == even)
+			merged += term.coeff;
 		else
-			return std::optional<Term>{};
+			merged -= term.coeff;
+
+		return std::optional<size_t>{};
+	});
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::mergeMapped(Mapping mapping) {
+	size_t termCount = this->terms.size();
+	MonomialTable keys;
+	TermKey key;
+
+	//Key identifiers and parities of terms
+	std::vector<size_t> ids(termCount);
+	std::vector<bool> evens(termCount);
+
+	//Key identifiers, parities and coefficients of term images
+	std::vector<size_t> imageIds(termCount);
+	std::vector<bool> imageEvens(termCount);
+	std::vector<Coeff> imageCoeffs;
+	imageCoeffs.reserve(termCount);
+
+	for (size_t i = 0; i < termCount; ++i) {
+		TermView term = std::as_const(this->terms)[i];
+		evens[i] = structuralKey(term, key);
+		ids[i] = keys.intern(key);
+
+		Term image{ term };
+		mapping(TermRef{ image.coeff, image.factors });
+		imageEvens[i] = structuralKey(image, key);
+		imageIds[i] = keys.intern(key);
+		imageCoeffs.push_back(image.coeff);
 	}
 
-	Term res{ t1 };
-	if (even)
-		res.coeff += t2.coeff;
-	else
-		res.coeff -= t2.coeff;
+	//Terms grouped by image key identifiers, in ascending order
+	std::vector<size_t> groupStart(keys.size() + 1, 0);
+	for (size_t id : imageIds)
+		++groupStart[id + 1];
+
+	for (size_t id = 0; id < keys.size(); ++id)
+		groupStart[id + 1] += groupStart[id];
+
+	std::vector<size_t> groups(termCount);
+	std::vector<size_t> groupFill{ groupStart.begin(), groupStart.end() - 1 };
+	for (size_t i = 0; i < termCount; ++i)
+		groups[groupFill[imageIds[i]]++] = i;
+
+	//Each term absorbs the following ones whose images match it
+	std::vector<bool> merged(termCount, false);
+	size_t pos = 0;
+	this->terms.rewrite([&](const TermRef& first) {
+		size_t i = pos++;
+		if (merged[i])
+			return std::optional<size_t>{};
+
+		for (size_t k = groupStart[ids[i]]; k < groupStart[ids[i] + 1];
+				++k) {
+			size_t j = groups[k];
+			if ((j <= i) || merged[j])
+				continue;
 
-	return res;
+			if (evens[i] == imageEvens[j])
+				first.coeff += imageCoeffs[j];
+			else
+				first.coeff -= imageCoeffs[j];
+
+			merged[j] = true;
+		}
+
+		return std::optional<size_t>{ first.factors.size() };
+	});
 }
 
 //----------------------------------------------------------------------
 
 template<typename Scalar>
-void TensorPolynomial<Scalar>::mergeTerms(Merger merger) {
-	typename TensorPolynomial<Scalar>::Terms tmpTerms;
-	tmpTerms.reserve(this->terms.size());
+bool TensorPolynomial<Scalar>::structuralKey(const TermView& term,
+												TermKey& key) {
+	key.assign(term.factors);
+	return key.even;
+}
 
-	typename TensorPolynomial<Scalar>::Terms rest = this->terms;
-	while (!rest.empty()) {
-		Term first = rest[0];
-		rest.erase(rest.begin());
+//----------------------------------------------------------------------
 
-		typename TensorPolynomial<Scalar>::Terms tmp;
-		tmp.reserve(rest.size());
-		for (Term& other: rest) {
-			std::optional<Term> merged = merger(first, other);
-			if (merged)
-				first = merged.value();
-			else
-				tmp.push_back(other);
+template<typename Scalar>
+bool TensorPolynomial<Scalar>::operator==(
+		const TensorPolynomial<Scalar>& other) const {
+	if (!isSorted()) {
+		TensorPolynomial<Scalar> sorted{ *this };
+		sorted.sortTerms();
+		return sorted == other;
+	}
+
+	if (!other.isSorted()) {
+		TensorPolynomial<Scalar> sorted{ other };
+		sorted.sortTerms();
+		return *this == sorted;
+	}
+
+	//Terms with zero coefficients are skipped
+	const Terms& terms1 = this->terms;
+	const Terms& terms2 = other.terms;
+	size_t i = 0;
+	size_t j = 0;
+	while (true) {
+		while ((i < terms1.size()) && (terms1.coeffs()[i] == zero<Scalar>()))
+			++i;
+
+		while ((j < terms2.size()) && (terms2.coeffs()[j] == zero<Scalar>()))
+			++j;
+
+		if ((i == terms1.size()) || (j == terms2.size()))
+			return (i == terms1.size()) && (j == terms2.size());
+
+		if ((terms1.coeffs()[i] != terms2.coeffs()[j])
+				|| (termOrder(terms1[i].factors, terms2[j].factors) != 0))
+			return false;
+
+		++i;
+		++j;
+	}
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::sortTerms() {
+	canonicalize();
+	sortCanonicalTerms();
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+void TensorPolynomial<Scalar>::sortCanonicalTerms() {
+	//Indices and factors of each term are ordered in place,
+	//merged terms which cancelled are dropped
+	this->terms.rewrite([](const TermRef& term) -> std::optional<size_t> {
+		for (Tensor& factor : term.factors) {
+			int sign = factor.canonicalize();
+			if (sign == 0)
+				return std::optional<size_t>{};
+
+			if (sign < 0)
+				term.coeff = -term.coeff;
 		}
 
-		tmpTerms.push_back(first);
-		rest = tmp;
+		if (term.coeff == zero<Scalar>())
+			return std::optional<size_t>{};
+
+		std::sort(term.factors.begin(), term.factors.end(),
+				[](const Tensor& t1, const Tensor& t2) {
+					return factorOrder(t1, t2) < 0;
+				});
+
+		return std::optional<size_t>{ term.factors.size() };
+	});
+
+	//Terms of a canonical polynomial have distinct factors,
+	//so the order is strict
+	const Terms& terms = this->terms;
+	std::vector<size_t> order(terms.size());
+	std::iota(order.begin(), order.end(), 0);
+	auto less = [&](size_t i, size_t j) {
+		return termOrder(terms[i].factors, terms[j].factors) < 0;
+	};
+
+	if (!std::is_sorted(order.begin(), order.end(), less)) {
+		std::sort(order.begin(), order.end(), less);
+
+		Terms res;
+		res.reserve(terms.size(), terms.factorCount());
+		for (size_t i : order)
+			res.push_back(terms[i]);
+
+		this->terms = std::move(res);
 	}
 
-	this->terms = tmpTerms;
+	_sorted = true;
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+std::strong_ordering TensorPolynomial<Scalar>::factorOrder(const Tensor& t1,
+															const Tensor& t2) {
+	auto rank = [](const Tensor& t) {
+		if (t.id() == Basis::eta)
+			return 0;
+
+		return (t.id() == Basis::delta) ? 1 : 2;
+	};
+
+	if (std::strong_ordering res = rank(t1) <=> rank(t2); res != 0)
+		return res;
+
+	const Tensor::Indices& indices1 = t1.indices();
+	const Tensor::Indices& indices2 = t2.indices();
+	return std::lexicographical_compare_three_way(
+			indices1.begin(), indices1.end(),
+			indices2.begin(), indices2.end());
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+std::strong_ordering TensorPolynomial<Scalar>::termOrder(
+		std::span<const Tensor> f1,
+		std::span<const Tensor> f2) {
+	return std::lexicographical_compare_three_way(
+			f1.begin(), f1.end(), f2.begin(), f2.end(), factorOrder);
+}
+
+//----------------------------------------------------------------------
+
+template<typename Scalar>
+TensorPolynomial<Scalar> TensorPolynomial<Scalar>::mergeSorted(
+		const TensorPolynomial<Scalar>& p1,
+		const TensorPolynomial<Scalar>& p2,
+		bool subtract) {
+	if (p2.terms.empty())
+		return p1;
+
+	if (p1.terms.empty())
+		return subtract ? -p2 : p2;
+
+	const Terms& terms1 = p1.terms;
+	const Terms& terms2 = p2.terms;
+	TensorPolynomial<Scalar> res;
+	res.terms.reserve(terms1.size() + terms2.size(),
+			terms1.factorCount() + terms2.factorCount());
+
+	auto append = [&](const Coeff& coeff, std::span<const Tensor> factors) {
+		if (coeff != zero<Scalar>())
+			res.terms.append(coeff, factors);
+	};
+
+	size_t i = 0;
+	size_t j = 0;
+	while ((i < terms1.size()) || (j < terms2.size())) {
+		std::strong_ordering order = (i == terms1.size())
+				? std::strong_ordering::greater
+				: ((j == terms2.size())
+					? std::strong_ordering::less
+					: termOrder(terms1[i].factors, terms2[j].factors));
+
+		if (order < 0) {
+			append(terms1.coeffs()[i], terms1[i].factors);
+			++i;
+		} else if (order > 0) {
+			const Coeff& coeff = terms2.coeffs()[j];
+			append(subtract ? -coeff : coeff, terms2[j].factors);
+			++j;
+		} else {
+			const Coeff& c1 = terms1.coeffs()[i];
+			const Coeff& c2 = terms2.coeffs()[j];
+			append(subtract ? c1 - c2 : c1 + c2, terms1[i].factors);
+			++i;
+			++j;
+		}
+	}
+
+	res._sorted = true;
+	return res;
 }
 
 //----------------------------------------------------------------------
@@ -0,0 +1,420 @@
+/*
+ * PackedTerms.hpp
+ *
+ * Contiguous storage of polynomial terms
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#ifndef SRC_ALGEBRA_PACKEDTERMS_HPP_
+#define SRC_ALGEBRA_PACKEDTERMS_HPP_
+
+#include <vector>
+#include <memory_resource>
+#include <span>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <stdexcept>
+#include <functional>
+#include <utility>
+#include <optional>
+#include <algorithm>
+#include <memory>
+
+namespace dirac {
+
+namespace algebra {
+
+/**
+ * Structure-of-arrays storage of polynomial terms.
+ * Coefficients of all terms are kept in one array,
+ * factors of all terms in another one, term boundaries
+ * in the third one: factors of i-th term occupy the range
+ * [offsets[i], offsets[i + 1]) of the factor array.
+ *
+ * Terms are accessed through lightweight views
+ * which reference the packed storage.
+ * Views are invalidated by any operation that appends terms.
+ *
+ * Factors and term boundaries are shared between copies
+ * and copied on the first modification, so copying terms
+ * in order to change their coefficients copies no factors.
+ * Use coeffs() to modify coefficients alone: mutable term views
+ * make the factor storage exclusive first.
+ *
+ * The arrays use the default polymorphic memory resource
+ * current at construction, see EvaluationArena.
+ */
+template<typename Coeff, typename Factor>
+class PackedTerms {
+public:
+	/**
+	 * Term view: coefficient reference and factor span
+	 */
+	template<bool IsConst>
+	struct BasicTermRef {
+		using CoeffType =
+				std::conditional_t<IsConst, const Coeff, Coeff>;
+		using FactorType =
+				std::conditional_t<IsConst, const Factor, Factor>;
+
+		CoeffType& coeff;
+		std::span<FactorType> factors;
+
+		BasicTermRef(CoeffType& c, std::span<FactorType> f)
+			: coeff{ c }, factors{ f } {}
+
+		/**
+		 * Read-only view of any term-like object, e.g. a standalone term
+		 */
+		template<typename T>
+		requires IsConst && requires(const T& t) {
+			{ t.coeff } -> std::convertible_to<const Coeff&>;
+			std::span<const Factor>{ t.factors };
+		}
+		BasicTermRef(const T& term)
+			: coeff{ term.coeff }, factors{ term.factors } {}
+	};
+
+	using TermRef = BasicTermRef<false>;
+	using TermView = BasicTermRef<true>;
+
+	/**
+	 * Forward iterator over term views
+	 */
+	template<bool IsConst>
+	class BasicIterator {
+	public:
+		using Owner = std::conditional_t<IsConst,
+									const PackedTerms, PackedTerms>;
+		using value_type = BasicTermRef<IsConst>;
+		using reference = value_type;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::forward_iterator_tag;
+
+		BasicIterator() = default;
+		BasicIterator(Owner* owner, size_t pos)
+			: _owner{ owner }, _pos{ pos } {}
+
+		reference operator*() const { return (*_owner)[_pos]; }
+
+		BasicIterator& operator++() {
+			++_pos;
+			return *this;
+		}
+
+		BasicIterator operator++(int) {
+			BasicIterator res{ *this };
+			++_pos;
+			return res;
+		}
+
+		bool operator==(const BasicIterator& other) const {
+			return (_pos == other._pos);
+		}
+
+		/**
+		 * Position of the referenced term
+		 */
+		size_t position() const { return _pos; }
+
+	private:
+		Owner* _owner = nullptr;
+		size_t _pos = 0;
+	};
+
+	using iterator = BasicIterator<false>;
+	using const_iterator = BasicIterator<true>;
+
+	PackedTerms() = default;
+	PackedTerms(const PackedTerms& other) = default;
+
+	/**
+	 * Move construction leaves the argument empty and usable
+	 */
+	PackedTerms(PackedTerms&& other) noexcept
+		: _coeffs{ std::move(other._coeffs) },
+		  _layout{ std::move(other._layout) } {
+		other._coeffs.clear();
+	}
+
+	PackedTerms& operator=(const PackedTerms& other) = default;
+
+	PackedTerms& operator=(PackedTerms&& other) noexcept {
+		if (&other == this)
+			return *this;
+
+		_coeffs = std::move(other._coeffs);
+		_layout = std::move(other._layout);
+		other._coeffs.clear();
+		return *this;
+	}
+
+	/**
+	 * Number of terms
+	 */
+	size_t size() const { return _coeffs.size(); }
+
+	bool empty() const { return _coeffs.empty(); }
+
+	/**
+	 * Total number of factors in all terms
+	 */
+	size_t factorCount() const {
+		return _layout ? _layout->factors.size() : 0;
+	}
+
+	/**
+	 * Reserves space for the specified number of terms and factors
+	 */
+	void reserve(size_t termCount, size_t factorCount = 0) {
+		_coeffs.reserve(termCount);
+		Layout& layout = exclusiveLayout();
+		layout.offsets.reserve(termCount + 1);
+		layout.factors.reserve(factorCount);
+	}
+
+	void clear() {
+		_coeffs.clear();
+		_layout.reset();
+	}
+
+	TermRef operator[](size_t pos) {
+		return TermRef{ _coeffs[pos], factorSpan(pos) };
+	}
+
+	TermView operator[](size_t pos) const {
+		return TermView{ _coeffs[pos], factorSpan(pos) };
+	}
+
+	TermRef front() { return (*this)[0]; }
+	TermView front() const { return (*this)[0]; }
+	TermRef back() { return (*this)[size() - 1]; }
+	TermView back() const { return (*this)[size() - 1]; }
+
+	iterator begin() { return iterator{ this, 0 }; }
+	iterator end() { return iterator{ this, size() }; }
+	const_iterator begin() const { return const_iterator{ this, 0 }; }
+	const_iterator end() const { return const_iterator{ this, size() }; }
+
+	/**
+	 * Packed coefficient array
+	 */
+	std::span<const Coeff> coeffs() const { return _coeffs; }
+
+	/**
+	 * Mutable packed coefficient array.
+	 * Modifying coefficients leaves the factor storage shared.
+	 */
+	std::span<Coeff> coeffs() { return _coeffs; }
+
+	/**
+	 * Packed factor array
+	 */
+	std::span<const Factor> factors() const {
+		if (!_layout)
+			return std::span<const Factor>{};
+
+		return _layout->factors;
+	}
+
+	/**
+	 * Appends a term with the given coefficient and the factors
+	 * being concatenation of the second and the third arguments
+	 */
+	void append(const Coeff& coeff,
+			std::span<const Factor> first = {},
+			std::span<const Factor> second = {}) {
+		if (aliases(first) || aliases(second)) {
+			std::vector<Factor> tmp{ first.begin(), first.end() };
+			tmp.insert(tmp.end(), second.begin(), second.end());
+			Coeff c{ coeff };
+			append(c, tmp);
+			return;
+		}
+
+		Layout& layout = exclusiveLayout();
+		_coeffs.push_back(coeff);
+		layout.factors.insert(layout.factors.end(),
+				first.begin(), first.end());
+		layout.factors.insert(layout.factors.end(),
+				second.begin(), second.end());
+		layout.offsets.push_back(layout.factors.size());
+	}
+
+	/**
+	 * Appends all terms of the argument
+	 */
+	void append(const PackedTerms& other) {
+		if (other.empty())
+			return;
+
+		if (empty()) {
+			_coeffs.assign(other._coeffs.begin(), other._coeffs.end());
+			_layout = other._layout;
+			return;
+		}
+
+		if (&other == this) {
+			PackedTerms tmp{ other };
+			append(tmp);
+			return;
+		}
+
+		Layout& layout = exclusiveLayout();
+		size_t base = layout.factors.size();
+		_coeffs.insert(_coeffs.end(),
+				other._coeffs.begin(), other._coeffs.end());
+		layout.factors.insert(layout.factors.end(),
+				other._layout->factors.begin(),
+				other._layout->factors.end());
+		const std::pmr::vector<size_t>& offsets = other._layout->offsets;
+		for (size_t i = 1; i < offsets.size(); ++i)
+			layout.offsets.push_back(base + offsets[i]);
+	}
+
+	/**
+	 * Appends a term-like object (a view or a standalone term)
+	 */
+	void push_back(const TermView& term) {
+		append(term.coeff, term.factors);
+	}
+
+	/**
+	 * Appends a term without factors
+	 */
+	void emplace_back(const Coeff& coeff) { append(coeff); }
+
+	/**
+	 * Appends a single-factor term
+	 */
+	void emplace_back(const Coeff& coeff, const Factor& factor) {
+		append(coeff, std::span<const Factor>{ &factor, 1 });
+	}
+
+	/**
+	 * Appends a factor to the last term.
+	 * Throws std::runtime_error if there are no terms.
+	 */
+	void appendFactor(const Factor& factor) {
+		if (empty())
+			throw std::runtime_error{ "No term to append a factor to" };
+
+		Layout& layout = exclusiveLayout();
+		layout.factors.push_back(factor);
+		layout.offsets.back() = layout.factors.size();
+	}
+
+	/**
+	 * Rewrites terms in place, preserving their order.
+	 * The argument is called on each term in turn; it may modify
+	 * the term and returns the number of its leading factors to keep
+	 * or an empty optional to drop the term. Kept terms are moved
+	 * towards the front, so no storage is allocated.
+	 * While the argument is called on i-th term, terms preceding it
+	 * are already rewritten and the first k of them are kept,
+	 * where k is the number of non-empty results returned so far.
+	 */
+	template<typename F>
+	requires std::is_invocable_r_v<std::optional<size_t>, F, TermRef>
+	void rewrite(F&& f) {
+		if (empty())
+			return;
+
+		std::pmr::vector<Factor>& factors = exclusiveLayout().factors;
+		std::pmr::vector<size_t>& offsets = _layout->offsets;
+		size_t count = size();
+		size_t kept = 0;
+		size_t begin = offsets[0];
+		for (size_t i = 0; i < count; ++i) {
+			size_t end = offsets[i + 1];
+			std::optional<size_t> keep = f(TermRef{ _coeffs[i],
+						std::span<Factor>{ factors.data() + begin,
+											end - begin } });
+			if (keep) {
+				size_t factorCount = std::min(keep.value(), end - begin);
+				size_t dest = offsets[kept];
+				if (dest != begin)
+					for (size_t j = 0; j < factorCount; ++j)
+						factors[dest + j] = std::move(factors[begin + j]);
+
+				if (kept != i)
+					_coeffs[kept] = std::move(_coeffs[i]);
+
+				++kept;
+				offsets[kept] = dest + factorCount;
+			}
+
+			begin = end;
+		}
+
+		_coeffs.erase(_coeffs.begin() + kept, _coeffs.end());
+		factors.erase(factors.begin() + offsets[kept], factors.end());
+		offsets.resize(kept + 1);
+	}
+
+private:
+	/**
+	 * Whether the argument points into the factor array
+	 */
+	bool aliases(std::span<const Factor> factors) const {
+		std::span<const Factor> own = this->factors();
+		if (factors.empty() || own.empty())
+			return false;
+
+		const Factor* first = own.data();
+		const Factor* last = first + own.size();
+		return std::less_equal<const Factor*>{}(first, factors.data())
+				&& std::less<const Factor*>{}(factors.data(), last);
+	}
+
+	std::span<Factor> factorSpan(size_t pos) {
+		Layout& layout = exclusiveLayout();
+		return std::span<Factor>{ layout.factors.data() + layout.offsets[pos],
+						layout.offsets[pos + 1] - layout.offsets[pos] };
+	}
+
+	std::span<const Factor> factorSpan(size_t pos) const {
+		const Layout& layout = *_layout;
+		return std::span<const Factor>{
+						layout.factors.data() + layout.offsets[pos],
+						layout.offsets[pos + 1] - layout.offsets[pos] };
+	}
+
+	/**
+	 * Factors of all terms and term boundaries
+	 */
+	struct Layout {
+		std::pmr::vector<Factor> factors;
+		std::pmr::vector<size_t> offsets = std::pmr::vector<size_t>(1, 0);
+	};
+
+	/**
+	 * Returns the factor storage, creating it if there is none
+	 * or copying it if it is shared
+	 */
+	Layout& exclusiveLayout() {
+		std::pmr::polymorphic_allocator<Layout> alloc;
+		if (!_layout)
+			_layout = std::allocate_shared<Layout>(alloc);
+		else if (_layout.use_count() > 1)
+			_layout = std::allocate_shared<Layout>(alloc, *_layout);
+
+		return *_layout;
+	}
+
+	std::pmr::vector<Coeff> _coeffs;
+
+	/**
+	 * Shared factor storage, empty if there are no terms
+	 */
+	std::shared_ptr<Layout> _layout;
+};
+
+}
+
+}
+
+#endif /* SRC_ALGEBRA_PACKEDTERMS_HPP_ */
@@ -0,0 +1,113 @@
+/*
+ * Parallel.cpp
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#include "Parallel.hpp"
+#include "Arena.hpp"
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include <exception>
+#include <thread>
+#include <algorithm>
+#include <unsupported/Eigen/CXX11/ThreadPool>
+
+namespace dirac {
+
+namespace algebra {
+
+namespace {
+
+size_t hardwareThreads() {
+	return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+}
+
+size_t& configuredThreads() {
+	static size_t count = hardwareThreads();
+	return count;
+}
+
+std::unique_ptr<Eigen::ThreadPool>& workerPool() {
+	static std::unique_ptr<Eigen::ThreadPool> pool;
+	return pool;
+}
+
+/**
+ * Returns the worker pool, starting it if necessary,
+ * or nullptr if parallel execution is disabled
+ */
+Eigen::ThreadPool* workers() {
+	size_t count = configuredThreads();
+	if (count < 2)
+		return nullptr;
+
+	std::unique_ptr<Eigen::ThreadPool>& pool = workerPool();
+	if (!pool)
+		pool = std::make_unique<Eigen::ThreadPool>(static_cast<int>(count));
+
+	return pool.get();
+}
+
+}
+
+//----------------------------------------------------------------------
+
+void setThreadCount(size_t count) {
+	if (count == 0)
+		count = hardwareThreads();
+
+	if (count == configuredThreads())
+		return;
+
+	configuredThreads() = count;
+	workerPool().reset();
+}
+
+//----------------------------------------------------------------------
+
+size_t threadCount() {
+	return configuredThreads();
+}
+
+//----------------------------------------------------------------------
+
+void parallelFor(size_t count, const std::function<void (size_t)>& task) {
+	Eigen::ThreadPool* pool = workers();
+	if (!pool || (count < 2) || (pool->CurrentThreadId() >= 0)) {
+		for (size_t i = 0; i < count; ++i)
+			task(i);
+
+		return;
+	}
+
+	//The default resource may be an EvaluationArena,
+	//which is not thread-safe
+	DefaultResourceScope scope{ std::pmr::new_delete_resource() };
+
+	std::vector<std::exception_ptr> errors(count);
+	Eigen::Barrier done{ static_cast<unsigned int>(count) };
+	for (size_t i = 0; i < count; ++i)
+		pool->Schedule([&, i]() {
+			try {
+				task(i);
+			} catch (...) {
+				errors[i] = std::current_exception();
+			}
+
+			done.Notify();
+		});
+
+	done.Wait();
+
+	for (const std::exception_ptr& error : errors)
+		if (error)
+			std::rethrow_exception(error);
+}
+
+} /* namespace algebra */
+
+} /* namespace dirac */
@@ -0,0 +1,52 @@
+/*
+ * Parallel.hpp
+ *
+ * Worker thread pool for parallel algorithms
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#ifndef SRC_ALGEBRA_PARALLEL_HPP_
+#define SRC_ALGEBRA_PARALLEL_HPP_
+
+#include <cstddef>
+#include <functional>
+
+namespace dirac {
+
+namespace algebra {
+
+/**
+ * Sets the number of worker threads used by parallel algorithms.
+ * 1 disables parallel execution, 0 selects the number
+ * of hardware threads, which is the default.
+ */
+void setThreadCount(size_t count);
+
+/**
+ * Number of worker threads used by parallel algorithms
+ */
+size_t threadCount();
+
+/**
+ * Calls the second argument for each of 0, 1, ..., count - 1
+ * on worker threads and waits for all calls to complete.
+ * Calls are made in order on the calling thread if parallel execution
+ * is disabled or the caller is a worker itself.
+ * If some calls throw, the exception thrown by the first of them
+ * is rethrown.
+ *
+ * While the calls run, the default polymorphic memory resource
+ * is replaced with a thread-safe one, see EvaluationArena.
+ * Memory allocated by the calls may thus be released on any thread,
+ * but they must not allocate or release memory of objects
+ * created before the invocation.
+ */
+void parallelFor(size_t count, const std::function<void (size_t)>& task);
+
+}
+
+}
+
+#endif /* SRC_ALGEBRA_PARALLEL_HPP_ */
@@ -6,41 +6,42 @@
  */
 
 #include "Permutations.hpp"
+#include <utility>
 
 namespace dirac {
 
 namespace algebra {
 
-void forPermutations(unsigned int n, PermutationWalker walker) {
-	if (n == 0) {
-		walker(Permutation{});
-		return;
-	}
+bool nextPermutation(Permutation& perm) {
+	auto& map = perm.map;
+	size_t n = map.size();
+	if (n < 2)
+		return false;
+
+	//Rightmost ascent
+	size_t i = n - 1;
+	while ((i > 0) && (map[i - 1] > map[i]))
+		--i;
+
+	if (i == 0)
+		return false;
+
+	--i;
+	size_t j = n - 1;
+	while (map[j] < map[i])
+		--j;
+
+	std::swap(map[i], map[j]);
+	bool even = !perm.isEven;
 
-	if (n == 1) {
-		Permutation triv;
-		triv.map.push_back(0);
-		walker(triv);
-		return;
+	//Reverse the descending tail
+	for (size_t l = i + 1, r = n - 1; l < r; ++l, --r) {
+		std::swap(map[l], map[r]);
+		even = !even;
 	}
 
-	for (unsigned int k = 0; k < n; ++k)
-		forPermutations(n - 1,
-			[k, n, &walker](const Permutation& rest) {
-				Permutation combo;
-				combo.map.reserve(n);
-				combo.map.push_back(k);
-				for (unsigned int l : rest.map)
-					if (l < k)
-						combo.map.push_back(l);
-					else
-						combo.map.push_back(l + 1);
-
-				bool kEven = (k % 2) == 0;
-				combo.isEven = (rest.isEven && kEven)
-										|| (!rest.isEven && !kEven);
-				walker(combo);
-			});
+	perm.isEven = even;
+	return true;
 }
 
 
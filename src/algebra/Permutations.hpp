@@ -8,13 +8,23 @@
 #ifndef SRC_ALGEBRA_PERMUTATIONS_HPP_
 #define SRC_ALGEBRA_PERMUTATIONS_HPP_
 
-#include <functional>
-#include <vector>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+#include <concepts>
+#include <algorithm>
+#include <stdexcept>
+#include "InlineVector.hpp"
 
 namespace dirac {
 
 namespace algebra {
 
+/**
+ * Largest number of elements a permutation can have
+ */
+constexpr unsigned int maxPermutationSize = 12;
+
 /**
  * n-element permutation representation.
  */
@@ -24,7 +34,7 @@ struct Permutation {
 	 * containing all integers from 0 to n-1
 	 * in arbitrary order.
 	 */
-	std::vector<unsigned int> map;
+	InlineVector<unsigned int, maxPermutationSize> map;
 
 	/**
 	 * Specifies whether the permutation is even,
@@ -34,12 +44,141 @@ struct Permutation {
 	bool isEven = true;
 };
 
-using PermutationWalker = std::function<void (const Permutation&)>;
+/**
+ * Permutation walker result. A walker may return Stop
+ * to end the enumeration early; walkers returning void
+ * see all permutations.
+ */
+enum class WalkResult {
+	Continue,
+	Stop
+};
+
+template<typename Walker>
+concept PermutationWalker = std::invocable<Walker&, const Permutation&>
+	&& (std::is_void_v<std::invoke_result_t<Walker&, const Permutation&>>
+		|| std::same_as<std::invoke_result_t<Walker&, const Permutation&>,
+						WalkResult>);
 
 /**
- * Recursively enumerates all permutations of n elements
+ * Precomputed permutations of N elements in lexicographic order
  */
-void forPermutations(unsigned int n, PermutationWalker walker);
+template<unsigned int N>
+struct PermutationTable {
+	static constexpr unsigned int count() {
+		unsigned int res = 1;
+		for (unsigned int i = 2; i <= N; ++i)
+			res *= i;
+
+		return res;
+	}
+
+	std::array<std::array<std::uint8_t, N>, count()> maps{};
+	std::array<bool, count()> even{};
+
+	constexpr PermutationTable() {
+		std::array<std::uint8_t, N> map{};
+		for (unsigned int i = 0; i < N; ++i)
+			map[i] = i;
+
+		for (unsigned int k = 0; k < count(); ++k) {
+			maps[k] = map;
+
+			unsigned int inversions = 0;
+			for (unsigned int i = 0; i < N; ++i)
+				for (unsigned int j = i + 1; j < N; ++j)
+					if (map[i] > map[j])
+						++inversions;
+
+			even[k] = ((inversions % 2) == 0);
+			std::next_permutation(map.begin(), map.end());
+		}
+	}
+};
+
+template<unsigned int N>
+inline constexpr PermutationTable<N> permutationTable{};
+
+/**
+ * Advances the argument to the next permutation in lexicographic order,
+ * updating its parity. Returns false if the argument
+ * is the last permutation.
+ */
+bool nextPermutation(Permutation& perm);
+
+/**
+ * Calls the walker, returns true if it requested to stop
+ */
+template<PermutationWalker Walker>
+inline bool walkStep(Walker& walker, const Permutation& perm) {
+	if constexpr (std::is_void_v<
+			std::invoke_result_t<Walker&, const Permutation&>>) {
+		walker(perm);
+		return false;
+	} else
+		return (walker(perm) == WalkResult::Stop);
+}
+
+/**
+ * Walks a precomputed permutation table
+ */
+template<unsigned int N, PermutationWalker Walker>
+bool walkTable(Walker& walker) {
+	const PermutationTable<N>& table = permutationTable<N>;
+	Permutation perm;
+	for (unsigned int i = 0; i < N; ++i)
+		perm.map.push_back(i);
+
+	for (unsigned int k = 0; k < table.count(); ++k) {
+		for (unsigned int i = 0; i < N; ++i)
+			perm.map[i] = table.maps[k][i];
+
+		perm.isEven = table.even[k];
+		if (walkStep(walker, perm))
+			return true;
+	}
+
+	return false;
+}
+
+/**
+ * Enumerates all permutations of n elements in lexicographic order.
+ * Permutations of up to 4 elements come from precomputed tables,
+ * longer ones are generated lazily.
+ * Returns true if the walker stopped the enumeration.
+ * Throws std::runtime_error if n exceeds maxPermutationSize.
+ */
+template<PermutationWalker Walker>
+bool forPermutations(unsigned int n, Walker&& walker) {
+	switch (n) {
+	case 0:
+		return walkTable<0>(walker);
+	case 1:
+		return walkTable<1>(walker);
+	case 2:
+		return walkTable<2>(walker);
+	case 3:
+		return walkTable<3>(walker);
+	case 4:
+		return walkTable<4>(walker);
+	default:
+		break;
+	}
+
+	if (n > maxPermutationSize)
+		throw std::runtime_error{ "Too many elements to permute" };
+
+	Permutation perm;
+	for (unsigned int i = 0; i < n; ++i)
+		perm.map.push_back(i);
+
+	do {
+		if (walkStep(walker, perm))
+			return true;
+	} while (nextPermutation(perm));
+
+	return false;
+}
 
 }
 
@@ -13,9 +13,12 @@
 #include "concepts.hpp"
 #include <memory>
 #include <vector>
+#include <memory_resource>
 #include <concepts>
 #include "concepts.hpp"
 #include <algorithm>
+#include <utility>
+#include "PackedTerms.hpp"
 
 namespace dirac {
 
@@ -42,7 +45,7 @@ struct Polynomial {
 	 */
 	struct Term {
 		Coeff coeff;
-		std::vector<Factor> factors;
+		std::pmr::vector<Factor> factors;
 
 		/**
 		 * Terms multiplication
@@ -81,9 +84,23 @@ struct Polynomial {
 
 		Term(const Coeff& c, const Factor& f) :
 						coeff{ c }, factors{ f } {}
+
+		/**
+		 * Copies a term out of packed storage
+		 */
+		template<bool IsConst>
+		Term(const PackedTerms<Coeff, Factor>::
+				template BasicTermRef<IsConst>& ref) :
+						coeff{ ref.coeff },
+						factors{ ref.factors.begin(), ref.factors.end() } {}
 	};
 
-	using Terms = std::vector<Term>;
+	/**
+	 * Terms are stored packed; see PackedTerms
+	 */
+	using Terms = PackedTerms<Coeff, Factor>;
+	using TermRef = typename Terms::TermRef;
+	using TermView = typename Terms::TermView;
 	Terms terms;
 
 	Polynomial() = default;
@@ -92,6 +109,8 @@ struct Polynomial {
 
 	Polynomial<Coeff, Factor>&
 	operator=(const Polynomial<Coeff, Factor>& other) = default;
+	Polynomial<Coeff, Factor>&
+	operator=(Polynomial<Coeff, Factor>&& other) = default;
 	virtual ~Polynomial() = default;
 
 	Polynomial(const Coeff& c) {
@@ -116,7 +135,25 @@ struct Polynomial {
 template<class P, typename CoeffType, typename Factor>
 requires std::derived_from<P, Polynomial<CoeffType, Factor> >
 P& add(P& p1, const P& p2) {
-	p1.terms.insert(p1.terms.end(), p2.terms.begin(), p2.terms.end());
+	p1.terms.append(p2.terms);
+	p1.canonicalize();
+	return p1;
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Mutating polynomial addition of a temporary.
+ * The argument's storage is taken over if the callee is empty.
+ */
+template<class P, typename CoeffType, typename Factor>
+requires std::derived_from<P, Polynomial<CoeffType, Factor> >
+P& add(P& p1, P&& p2) {
+	if (p1.terms.empty())
+		p1.terms = std::move(p2.terms);
+	else
+		p1.terms.append(p2.terms);
+
 	p1.canonicalize();
 	return p1;
 }
@@ -135,21 +172,28 @@ P sum(const P& p1, const P& p2) {
 
 //----------------------------------------------------------------------
 
+/**
+ * Polynomial addition reusing the first argument's storage
+ */
+template<class P, typename CoeffType, typename Factor>
+requires std::derived_from<P, Polynomial<CoeffType, Factor> >
+P sum(P&& p1, const P& p2) {
+	add<P, CoeffType, Factor>(p1, p2);
+	return std::move(p1);
+}
+
+//----------------------------------------------------------------------
+
 /**
  * Mutating polynomial subtraction ("-=" operator)
  */
 template<class P, typename CoeffType, typename Factor>
 requires std::derived_from<P, Polynomial<CoeffType, Factor> >
 P& sub(P& p1, const P& p2) {
-	using Term = Polynomial<CoeffType, Factor>::Term;
-
-	size_t firstTermCount = p1.terms.size();
-	p1.terms.resize(p1.terms.size() + p2.terms.size());
-	std::transform(p2.terms.begin(), p2.terms.end(),
-			p1.terms.begin() + firstTermCount,
-			[](const Term& t) {
-				return -t;
-			});
+	size_t size = p1.terms.size();
+	p1.terms.append(p2.terms);
+	for (CoeffType& c : p1.terms.coeffs().subspan(size))
+		c = -c;
 
 	p1.canonicalize();
 	return p1;
@@ -170,23 +214,60 @@ P diff(const P& p1, const P& p2) {
 //----------------------------------------------------------------------
 
 /**
- * Polynomial negation
+ * Polynomial subtraction reusing the first argument's storage
  */
 template<class P, typename CoeffType, typename Factor>
 requires std::derived_from<P, Polynomial<CoeffType, Factor> >
-P negate(const P& p) {
-	P res;
+P diff(P&& p1, const P& p2) {
+	sub<P, CoeffType, Factor>(p1, p2);
+	return std::move(p1);
+}
 
-	using Term = Polynomial<CoeffType, Factor>::Term;
+//----------------------------------------------------------------------
 
-	res.terms.resize(p.terms.size());
-	std::transform(p.terms.begin(), p.terms.end(),
-			res.terms.begin(),
-			[](const Term& t) {
-				return -t;
-			});
+/**
+ * In-place negation of a temporary polynomial
+ */
+template<class P, typename CoeffType, typename Factor>
+requires std::derived_from<P, Polynomial<CoeffType, Factor> >
+P negate(P&& p) {
+	for (CoeffType& c : p.terms.coeffs())
+		c = -c;
+
+	return std::move(p);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Polynomial negation.
+ * The result shares factor storage with the argument.
+ */
+template<class P, typename CoeffType, typename Factor>
+requires std::derived_from<P, Polynomial<CoeffType, Factor> >
+P negate(const P& p) {
+	return negate<P, CoeffType, Factor>(P{ p });
+}
+
+//----------------------------------------------------------------------
 
-	return res;
+/**
+ * Appends pairwise products of the second and the third arguments' terms
+ * to the first argument, without canonicalization
+ */
+template<typename Coeff, typename Factor>
+void appendProducts(PackedTerms<Coeff, Factor>& dest,
+		const PackedTerms<Coeff, Factor>& terms1,
+		const PackedTerms<Coeff, Factor>& terms2) {
+	size_t size1 = terms1.size();
+	size_t size2 = terms2.size();
+	dest.reserve(dest.size() + size1 * size2,
+			dest.factorCount() + terms1.factorCount() * size2
+				+ terms2.factorCount() * size1);
+
+	for (const auto& t1 : terms1)
+		for (const auto& t2 : terms2)
+			dest.append(t1.coeff * t2.coeff, t1.factors, t2.factors);
 }
 
 //----------------------------------------------------------------------
@@ -204,11 +285,7 @@ P prod(const P& p1, const P& p2) {
 	if (total == 0)
 		return prod;
 
-	prod.terms.reserve(total);
-	for (size_t i = 0; i < size1; ++i)
-		for (size_t j = 0; j < size2; ++j)
-			prod.terms.emplace_back(p1.terms[i] * p2.terms[j]);
-
+	appendProducts(prod.terms, p1.terms, p2.terms);
 	prod.canonicalize();
 
 	return prod;
@@ -217,26 +294,41 @@ P prod(const P& p1, const P& p2) {
 //----------------------------------------------------------------------
 
 /**
- * Left multiplication of a polynomial by number
+ * In-place left multiplication of a temporary polynomial by number
+ */
+template<class P, typename Coeff, typename Factor>
+requires std::derived_from<P, Polynomial<Coeff, Factor> >
+P prod(const Coeff& c, P&& p) {
+	for (Coeff& coeff : p.terms.coeffs())
+		coeff = c * coeff;
+
+	return std::move(p);
+}
+
+//----------------------------------------------------------------------
+
+/**
+ * Left multiplication of a polynomial by number.
+ * The result shares factor storage with the argument.
  */
 template<class P, typename Coeff, typename Factor>
 requires std::derived_from<P, Polynomial<Coeff, Factor> >
 P prod(const Coeff& c, const P& p) {
-	P prod;
-	if (p.terms.empty())
-		return prod;
+	return prod<P, Coeff, Factor>(c, P{ p });
+}
 
-	using Term = Polynomial<Coeff, Factor>::Term;
-	prod.terms.resize(p.terms.size());
-	std::transform(p.terms.begin(), p.terms.end(),
-			prod.terms.begin(),
-			[&c](const Term& t) {
-				Term res{ t };
-				res.coeff = c * t.coeff;
-				return res;
-			});
+//----------------------------------------------------------------------
 
-	return prod;
+/**
+ * In-place right multiplication of a temporary polynomial by number
+ */
+template<class P, typename Coeff, typename Factor>
+requires std::derived_from<P, Polynomial<Coeff, Factor> >
+P prod(P&& p, const Coeff& c) {
+	for (Coeff& coeff : p.terms.coeffs())
+		coeff = coeff * c;
+
+	return std::move(p);
 }
 
 //----------------------------------------------------------------------
@@ -244,26 +336,113 @@ P prod(const Coeff& c, const P& p) {
 /**
  * Right multiplication of a polynomial by number.
  * Note that in the most general case numbers may be non-commutative.
+ * The result shares factor storage with the argument.
  */
 template<class P, typename Coeff, typename Factor>
 requires std::derived_from<P, Polynomial<Coeff, Factor> >
 P prod(const P& p, const Coeff& c) {
-	P prod;
-	if (p.terms.empty())
-		return prod;
+	return prod<P, Coeff, Factor>(P{ p }, c);
+}
 
-	using Term = Polynomial<Coeff, Factor>::Term;
-	prod.terms.resize(p.terms.size());
-	std::transform(p.terms.begin(), p.terms.end(),
-			prod.terms.begin(),
-			[&c](const Term& t) {
-				Term res{ t };
-				res.coeff = t.coeff * c;
-				return res;
-			});
+//----------------------------------------------------------------------
 
-	return prod;
-}
+/**
+ * Polynomial accumulator.
+ * Sums and products are collected term by term
+ * without canonicalization, which is performed once by finalize().
+ * Use it instead of repeated "+=" when building large sums:
+ * every "+=" canonicalizes the whole accumulated polynomial.
+ */
+template<class P>
+requires requires(P& p) { p.terms; p.canonicalize(); }
+class PolynomialBuilder {
+public:
+	PolynomialBuilder() = default;
+
+	/**
+	 * Starts accumulation from the argument
+	 */
+	explicit PolynomialBuilder(const P& initial) : _value{ initial } {}
+
+	/**
+	 * Appends the argument's terms
+	 */
+	PolynomialBuilder& operator+=(const P& p) {
+		_value.terms.append(p.terms);
+		return *this;
+	}
+
+	/**
+	 * Appends the terms of a temporary,
+	 * taking over its storage if nothing is accumulated yet
+	 */
+	PolynomialBuilder& operator+=(P&& p) {
+		if (_value.terms.empty())
+			_value.terms = std::move(p.terms);
+		else
+			_value.terms.append(p.terms);
+
+		return *this;
+	}
+
+	/**
+	 * Appends a single term
+	 */
+	PolynomialBuilder&
+	addTerm(const typename P::Terms::TermView& term) {
+		_value.terms.push_back(term);
+		return *this;
+	}
+
+	/**
+	 * Appends the argument's terms negated
+	 */
+	PolynomialBuilder& operator-=(const P& p) {
+		size_t size = _value.terms.size();
+		_value.terms.append(p.terms);
+		for (auto& c : _value.terms.coeffs().subspan(size))
+			c = -c;
+
+		return *this;
+	}
+
+	/**
+	 * Appends the product of the arguments
+	 */
+	PolynomialBuilder& addProduct(const P& p1, const P& p2) {
+		appendProducts(_value.terms, p1.terms, p2.terms);
+		return *this;
+	}
+
+	/**
+	 * Right-multiplies the accumulated value by the argument
+	 */
+	PolynomialBuilder& operator*=(const P& p) {
+		typename P::Terms res;
+		appendProducts(res, _value.terms, p.terms);
+		_value.terms = std::move(res);
+		return *this;
+	}
+
+	/**
+	 * Number of accumulated terms
+	 */
+	size_t size() const { return _value.terms.size(); }
+
+	/**
+	 * Canonicalizes and returns the accumulated value,
+	 * leaving the builder empty
+	 */
+	P finalize() {
+		P res{ std::move(_value) };
+		_value = P{};
+		res.canonicalize();
+		return res;
+	}
+
+private:
+	P _value;
+};
 
 } /*namespace algebra*/
 
@@ -17,6 +17,11 @@ namespace algebra {
 //----------------------------------------------------------------------
 
 void Rational::normalize() {
+	//Zero is kept as 0/1, so that sums of cancelling terms
+	//do not accumulate denominators until they overflow
+	if ((absNum() == 0) && (_den != 0))
+		_den = 1;
+
 	if ((absNum() == 0) || (_den == 0)
 			|| (absNum() == 1) || (_den == 1))
 		return;
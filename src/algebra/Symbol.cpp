@@ -0,0 +1,87 @@
+/*
+ * Symbol.cpp
+ *
+ * Global symbol table
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#include "Symbol.hpp"
+#include <deque>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <stdexcept>
+
+namespace dirac {
+
+namespace algebra {
+
+namespace {
+
+/**
+ * Symbol table storage.
+ * Names are kept in a deque so that references to them
+ * stay valid while new symbols are interned.
+ */
+struct SymbolTable {
+	std::deque<std::string> names;
+	std::unordered_map<std::string, Symbol::Handle> handles;
+	std::mutex lock;
+
+	SymbolTable() {
+		names.emplace_back();
+		handles.emplace(names.back(), 0);
+	}
+};
+
+/**
+ * The table is constructed on first use, so basis symbol constants
+ * defined in other translation units may be initialized in any order.
+ */
+SymbolTable& table() {
+	static SymbolTable instance;
+	return instance;
+}
+
+}
+
+//----------------------------------------------------------------------
+
+Symbol::Handle Symbol::intern(const std::string& name) {
+	SymbolTable& symbols = table();
+	std::lock_guard<std::mutex> guard{ symbols.lock };
+
+	auto iHandle = symbols.handles.find(name);
+	if (iHandle != symbols.handles.end())
+		return iHandle->second;
+
+	Handle handle = static_cast<Handle>(symbols.names.size());
+	symbols.names.push_back(name);
+	symbols.handles.emplace(name, handle);
+	return handle;
+}
+
+//----------------------------------------------------------------------
+
+const std::string& Symbol::name(Handle handle) {
+	//Names never move, so each thread keeps their addresses
+	//and takes the lock only for symbols it has not looked up yet
+	thread_local std::vector<const std::string*> known;
+	if ((handle < known.size()) && known[handle])
+		return *known[handle];
+
+	SymbolTable& symbols = table();
+	std::lock_guard<std::mutex> guard{ symbols.lock };
+	const std::string& res = symbols.names.at(handle);
+	if (known.size() <= handle)
+		known.resize(symbols.names.size(), nullptr);
+
+	known[handle] = &res;
+	return res;
+}
+
+}
+
+}
@@ -0,0 +1,97 @@
+/*
+ * Symbol.hpp
+ *
+ * Interned identifier type
+ *
+ *  Created on: Oct 17, 2026
+ *      Author: skutnii
+ */
+
+#ifndef SRC_ALGEBRA_SYMBOL_HPP_
+#define SRC_ALGEBRA_SYMBOL_HPP_
+
+#include <string>
+#include <compare>
+#include <functional>
+
+namespace dirac {
+
+namespace algebra {
+
+/**
+ * Interned identifier.
+ * A symbol is a small integer handle into the global symbol table,
+ * so copying and comparing symbols never touches the underlying string.
+ * Handles are assigned in interning order and never released.
+ */
+class Symbol {
+public:
+	using Handle = unsigned int;
+
+	/**
+	 * Empty symbol (interned empty string)
+	 */
+	Symbol() = default;
+	Symbol(const Symbol& other) = default;
+
+	/**
+	 * Interns the argument. Equal strings yield equal symbols.
+	 */
+	Symbol(const std::string& name) : _handle{ intern(name) } {}
+	Symbol(const char* name) : Symbol{ std::string{ name } } {}
+
+	Symbol& operator=(const Symbol& other) = default;
+
+	/**
+	 * String the symbol was interned from
+	 */
+	const std::string& str() const { return name(_handle); }
+
+	/**
+	 * Symbol table handle
+	 */
+	Handle handle() const { return _handle; }
+
+	bool operator==(const Symbol& other) const = default;
+
+	/**
+	 * Symbols are ordered by their handles, that is,
+	 * by the order in which they were interned.
+	 */
+	std::strong_ordering operator<=>(const Symbol& other) const = default;
+
+	/**
+	 * Returns the handle of the argument,
+	 * adding it to the symbol table if necessary
+	 */
+	static Handle intern(const std::string& name);
+
+	/**
+	 * Returns the string identified by a handle.
+	 * Throws std::out_of_range on invalid handle.
+	 */
+	static const std::string& name(Handle handle);
+
+private:
+	Handle _handle = 0;
+};
+
+} /* namespace algebra */
+
+} /* namespace dirac */
+
+namespace std {
+
+/**
+ * Hash specialization for symbols
+ */
+template<>
+struct hash<dirac::algebra::Symbol> {
+	size_t operator()(const dirac::algebra::Symbol& s) const {
+		return static_cast<size_t>(s.handle());
+	}
+};
+
+}
+
+#endif /* SRC_ALGEBRA_SYMBOL_HPP_ */
@@ -15,9 +15,13 @@
 #include <optional>
 #include <memory>
 #include <limits>
+#include <array>
+#include <utility>
+#include <functional>
 
 #include "concepts.hpp"
 #include "Tensorial.hpp"
+#include "InlineVector.hpp"
 
 #include "Permutations.hpp"
 
@@ -26,12 +30,25 @@ namespace dirac {
 namespace algebra {
 
 /**
- * Requirements for a tensor ring basis
+ * Symmetry of a basis element under permutations of its indices
+ */
+enum class IndexSymmetry {
+	None,
+	Symmetric,
+	Antisymmetric
+};
+
+/**
+ * Requirements for a tensor ring basis.
+ * indexCapacity is the compile-time upper bound
+ * of maxIndexCount over all basis elements.
  */
 template<typename T, typename IdType>
 concept TensorBasis = requires(const IdType& id) {
 	{ T::allows(id) } -> std::same_as<bool>;
 	{ T::maxIndexCount(id) } -> std::same_as<size_t>;
+	{ T::symmetry(id) } -> std::same_as<IndexSymmetry>;
+	{ T::indexCapacity } -> std::convertible_to<size_t>;
 };
 
 /**
@@ -48,7 +65,7 @@ class TensorBase {
 public:
 	using Self = TensorBase<IdType, Basis, IndexIdType>;
 	using Index = IndexBase<IndexIdType>;
-	using Indices = std::vector<Index>;
+	using Indices = InlineVector<Index, Basis::indexCapacity>;
 
 	TensorBase() = delete;
 	TensorBase(const Self& other) = default;
@@ -105,8 +122,8 @@ public:
 
 
 		Self res{ *this };
-		res._indices.insert(res._indices.end(),
-				indices.begin(), indices.end());
+		for (const Index& idx : indices)
+			res._indices.push_back(idx);
 
 		return res;
 	}
@@ -158,7 +175,6 @@ public:
 			throw std::runtime_error{ "Too many tensor indices" };
 
 		Indices tmp;
-		tmp.reserve(idxCount);
 		for (IBegin it = indexStart; it != indexEnd; ++it)
 			tmp.emplace_back(*it, isUpper);
 
@@ -184,6 +200,47 @@ public:
 		return true;
 	}
 
+	/**
+	 * Index symmetry of the element
+	 */
+	IndexSymmetry symmetry() const { return Basis::symmetry(_id); }
+
+	/**
+	 * Brings the tensor to canonical form: indices of symmetric
+	 * and antisymmetric elements are sorted by the argument,
+	 * by default as by IndexBase::operator<=>.
+	 * Returns the sign acquired: -1 if antisymmetric indices
+	 * were reordered by an odd permutation, 0 if antisymmetric
+	 * indices repeat (so the tensor vanishes), 1 otherwise.
+	 * Two tensors are equal up to sign if their canonical forms
+	 * with respect to the same order are equal.
+	 */
+	template<typename Less = std::less<Index>>
+	int canonicalize(Less less = Less{}) {
+		IndexSymmetry sym = symmetry();
+		if (sym == IndexSymmetry::None)
+			return 1;
+
+		//Insertion sort counting transpositions
+		bool even = true;
+		for (size_t i = 1; i < _indices.size(); ++i)
+			for (size_t j = i;
+					(j > 0) && less(_indices[j], _indices[j - 1]);
+					--j) {
+				std::swap(_indices[j], _indices[j - 1]);
+				even = !even;
+			}
+
+		if (sym == IndexSymmetry::Symmetric)
+			return 1;
+
+		for (size_t i = 1; i < _indices.size(); ++i)
+			if (_indices[i] == _indices[i - 1])
+				return 0;
+
+		return even ? 1 : -1;
+	}
+
 	/**
 	 * Replaces the index at position specified by the first argument
 	 * with the second argument. Exception is thrown on range error.
@@ -205,20 +262,30 @@ public:
 				|| (_indices.size() != other._indices.size()))
 			return res;
 
-		forPermutations(_indices.size(),
-			[&](const Permutation& perm) {
-				if (res)
-					return;
-
-				bool match = true;
-				for (size_t i = 0; i < _indices.size(); ++i)
-					if (_indices[perm.map[i]] != other._indices[i])
-						match = false;
-
-				if (match)
-					res = perm;
-			});
-
+		//Each index is matched to the first unused equal one,
+		//which yields the lexicographically first mapping
+		Permutation perm;
+		std::array<bool, Basis::indexCapacity> used{};
+		size_t size = _indices.size();
+		for (size_t i = 0; i < size; ++i) {
+			size_t j = 0;
+			while ((j < size)
+					&& (used[j] || (_indices[j] != other._indices[i])))
+				++j;
+
+			if (j == size)
+				return res;
+
+			used[j] = true;
+			perm.map.push_back(j);
+		}
+
+		for (size_t i = 0; i < size; ++i)
+			for (size_t j = i + 1; j < size; ++j)
+				if (perm.map[i] > perm.map[j])
+					perm.isEven = !perm.isEven;
+
+		res = perm;
 		return res;
 	}
 
@@ -227,7 +294,8 @@ private:
 			const Indices& indices = {})
 	: _id{ id },
 	  _indices{ indices },
-	  _maxIndices{ Basis::maxIndexCount(id) } {}
+	  _maxIndices{
+		  static_cast<unsigned int>(Basis::maxIndexCount(id)) } {}
 
 	/**
 	 * Checks whether actual index count + the argument is lesser than
@@ -246,7 +314,7 @@ private:
 
 	IdType _id;
 	Indices _indices;
-	size_t _maxIndices = 0;
+	unsigned int _maxIndices = 0;
 };
 
 
@@ -12,6 +12,8 @@
 
 #include <string>
 #include <vector>
+#include <cstdint>
+#include <compare>
 #include "IndexId.hpp"
 
 namespace dirac {
@@ -19,34 +21,58 @@ namespace dirac {
 namespace algebra {
 
 /**
- * Tensor index base type
+ * Tensor index base type.
+ * The identifier and the index position are packed
+ * into a single 32-bit word: the position flag occupies
+ * the top bit, which packed identifiers leave clear.
  */
-template<Hashable IdType>
-struct IndexBase {
+template<PackedIndexId IdType>
+class IndexBase {
+public:
+	IndexBase(const IdType& aId, bool upper)
+		: _bits{ aId.raw() | (upper ? upperBit : 0u) } {}
+
+	IndexBase(const IndexBase& other) = default;
+	IndexBase(IndexBase&& other) = default;
+	IndexBase() = delete;
+
+	IndexBase& operator=(const IndexBase& other) = default;
+
 	/**
 	 * Index label
 	 */
-	IdType id;
+	IdType id() const { return IdType::fromRaw(_bits & ~upperBit); }
 
 	/**
 	 * Index position: upper or lower
 	 */
-	bool isUpper = true;
-
-	IndexBase(const IdType& aId, bool upper)
-		: id{ aId }, isUpper{ upper } {}
+	bool isUpper() const { return (_bits & upperBit) != 0; }
 
-	IndexBase(const IndexBase& other) = default;
-	IndexBase(IndexBase&& other) = default;
-	IndexBase() = delete;
-
-	IndexBase& operator=(const IndexBase& other) = default;
+	/**
+	 * Packed representation
+	 */
+	std::uint32_t raw() const { return _bits; }
 
 	/**
 	 * Equality check
 	 */
 	bool operator==(const IndexBase& other) const {
-		return (isUpper == other.isUpper) && (id == other.id);
+		return (_bits == other._bits);
+	}
+
+	/**
+	 * Upper indices go before lower ones,
+	 * indices of the same position are ordered by identifiers
+	 */
+	std::strong_ordering operator<=>(const IndexBase& other) const {
+		if (_bits == other._bits)
+			return std::strong_ordering::equal;
+
+		if (std::strong_ordering res = other.isUpper() <=> isUpper();
+				res != 0)
+			return res;
+
+		return id() <=> other.id();
 	}
 
 	/**
@@ -56,8 +82,13 @@ struct IndexBase {
 	 * Two dual indices may be contracted.
 	 */
 	bool dual(const IndexBase<IdType>& other) const {
-		return (id == other.id) && (isUpper == !other.isUpper);
+		return ((_bits ^ other._bits) == upperBit);
 	}
+
+private:
+	static constexpr std::uint32_t upperBit = 1u << 31;
+
+	std::uint32_t _bits;
 };
 
 using TensorIndex = IndexBase<IndexId>;
@@ -72,12 +103,11 @@ namespace std {
 /**
  * Hash specialization for indices
  */
-template<dirac::Hashable IdType>
+template<dirac::algebra::PackedIndexId IdType>
 struct hash<dirac::algebra::IndexBase<IdType>> {
 	size_t
 	operator()(const dirac::algebra::IndexBase<IdType>& idx) const {
-		return std::hash<IdType>{}(idx.id)
-				^ static_cast<size_t>(idx.isUpper);
+		return static_cast<size_t>(idx.raw());
 	}
 };
 